@@ -0,0 +1,79 @@
+#include <stdatomic.h>
+#include <stddef.h>
+#include "alloccount.h"
+
+void *
+__real_malloc(size_t size);
+
+void *
+__real_calloc(size_t nmemb, size_t size);
+
+void *
+__real_realloc(void *ptr, size_t size);
+
+void
+__real_free(void *ptr);
+
+void *
+__wrap_malloc(size_t size);
+
+void *
+__wrap_calloc(size_t nmemb, size_t size);
+
+void *
+__wrap_realloc(void *ptr, size_t size);
+
+void
+__wrap_free(void *ptr);
+
+static atomic_uint_fast64_t allocs;
+static atomic_uint_fast64_t frees;
+static atomic_uint_fast64_t bytes;
+
+static void
+alloccount_add(size_t size)
+{
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bytes, size, memory_order_relaxed);
+}
+
+void *
+__wrap_malloc(size_t size)
+{
+    alloccount_add(size);
+    return __real_malloc(size);
+}
+
+void *
+__wrap_calloc(size_t nmemb, size_t size)
+{
+    alloccount_add(nmemb * size);
+    return __real_calloc(nmemb, size);
+}
+
+void *
+__wrap_realloc(void *ptr, size_t size)
+{
+    alloccount_add(size);
+    return __real_realloc(ptr, size);
+}
+
+void
+__wrap_free(void *ptr)
+{
+    if (ptr != NULL)
+    {
+        atomic_fetch_add_explicit(&frees, 1, memory_order_relaxed);
+    }
+    __real_free(ptr);
+}
+
+AllocCount
+alloccount_get(void)
+{
+    return (AllocCount) {
+        .allocs = atomic_load_explicit(&allocs, memory_order_relaxed),
+        .frees = atomic_load_explicit(&frees, memory_order_relaxed),
+        .bytes = atomic_load_explicit(&bytes, memory_order_relaxed),
+    };
+}
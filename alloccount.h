@@ -0,0 +1,19 @@
+#ifndef ALLOCCOUNT_H
+#define ALLOCCOUNT_H
+
+#include <stdint.h>
+
+// counts calls made through malloc and friends by objects linked with
+// -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free
+typedef struct AllocCount
+{
+    uint64_t allocs;
+    uint64_t frees;
+    uint64_t bytes;
+}
+AllocCount;
+
+AllocCount
+alloccount_get(void);
+
+#endif // !ALLOCCOUNT_H
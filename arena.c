@@ -0,0 +1,42 @@
+#include <stdalign.h>
+#include <stdlib.h>
+#include "arena.h"
+
+#define ARENA_ALIGN alignof(max_align_t)
+
+size_t
+arena_footprint(size_t size)
+{
+    return (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+bool
+arena_init(Arena *arena, size_t size)
+{
+    arena->base = calloc(1, size);
+    arena->size = size;
+    arena->used = 0;
+    return arena->base != NULL;
+}
+
+void
+arena_release(Arena *arena)
+{
+    free(arena->base);
+    arena->base = NULL;
+    arena->size = 0;
+    arena->used = 0;
+}
+
+void *
+arena_alloc(Arena *arena, size_t size)
+{
+    size_t footprint = arena_footprint(size);
+    if (footprint > arena->size - arena->used)
+    {
+        return NULL;
+    }
+    void *ptr = arena->base + arena->used;
+    arena->used += footprint;
+    return ptr;
+}
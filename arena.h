@@ -0,0 +1,32 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// One zero filled block handed out by bumping an offset and released all at
+// once. Sized up front from what will live in it, with arena_footprint, so
+// nothing is allocated once it is set up.
+typedef struct Arena
+{
+    unsigned char *base;
+    size_t size;
+    size_t used;
+}
+Arena;
+
+// bytes arena_alloc takes for size bytes, alignment included
+size_t
+arena_footprint(size_t size);
+
+bool
+arena_init(Arena *arena, size_t size);
+
+void
+arena_release(Arena *arena);
+
+// aligned for any type; NULL if the arena is out of room
+void *
+arena_alloc(Arena *arena, size_t size);
+
+#endif // !ARENA_H
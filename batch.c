@@ -0,0 +1,270 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "policy.h"
+#include "snakecore.h"
+#include "timer.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_LENGTH 15
+#define DEFAULT_GAMES 1000
+
+typedef struct GameResult {
+    int score;
+    long ticks;
+    bool won;
+    bool stalled;
+} GameResult;
+
+// games [begin, end) are dealt to a worker up front; idle workers steal
+// from the others by claiming indices off the same counter
+typedef struct WorkRange {
+    atomic_int next;
+    int end;
+} WorkRange;
+
+typedef struct Batch {
+    int nlines;
+    int ncols;
+    uint64_t seed;
+    Policy const *policy;
+    // per choice for policies that search, 0 for their own default
+    int64_t budget_ns;
+    int ngames;
+    int nworkers;
+    WorkRange *ranges;
+    GameResult *results;
+} Batch;
+
+typedef struct Worker {
+    Batch *batch;
+    int id;
+    pthread_t thread;
+} Worker;
+
+static int batch_claim(WorkRange *range) {
+    if (atomic_load_explicit(&range->next, memory_order_relaxed) >=
+        range->end) {
+        return -1;
+    }
+    int game = atomic_fetch_add_explicit(&range->next, 1, memory_order_relaxed);
+    return game < range->end ? game : -1;
+}
+
+static int batch_next_game(Batch *batch, int id) {
+    int game = batch_claim(&batch->ranges[id]);
+    for (int i = 1; game < 0 && i < batch->nworkers; i++) {
+        game = batch_claim(&batch->ranges[(id + i) % batch->nworkers]);
+    }
+    return game;
+}
+
+// plays on the worker's snake, reset in place for each game
+static GameResult batch_play(Batch *batch, Snake *snake, void *policy_state,
+                             int game) {
+    GameResult result = {0};
+    snake_reset(snake, batch->seed + game);
+    batch->policy->reset(policy_state, ~(batch->seed + game));
+
+    long stall_limit =
+        (long)batch->nlines * batch->ncols * SNAKE_STALL_TICKS_PER_CELL;
+    long since_food = 0;
+    int length = snake->deq->length;
+    while (snake->state != STATE_lose && snake->state != STATE_win) {
+        snake_set_direction(snake,
+                            batch->policy->choose(policy_state, snake));
+        if (snake_update(snake) != SNAKE_ERROR_none) {
+            break;
+        }
+        result.ticks++;
+
+        if (snake->deq->length != length) {
+            length = snake->deq->length;
+            since_food = 0;
+        } else if (++since_food > stall_limit) {
+            result.stalled = true;
+            break;
+        }
+    }
+    result.score = snake->deq->length;
+    result.won = snake->state == STATE_win;
+    return result;
+}
+
+static void *batch_worker(void *arg) {
+    Worker *worker = arg;
+    Batch *batch = worker->batch;
+    void *policy_state =
+        batch->policy->create(batch->nlines, batch->ncols, batch->seed);
+    Snake *snake = snake_new(batch->nlines, batch->ncols, batch->seed);
+    if (policy_state == NULL || snake == NULL) {
+        fprintf(stderr, "%s\n", snake_error_str(SNAKE_ERROR_alloc));
+        exit(1);
+    }
+    if (batch->budget_ns > 0 && batch->policy->set_budget != NULL) {
+        batch->policy->set_budget(policy_state, batch->budget_ns);
+    }
+
+    int game;
+    while ((game = batch_next_game(batch, worker->id)) >= 0) {
+        batch->results[game] = batch_play(batch, snake, policy_state, game);
+    }
+
+    snake_destroy(snake);
+    batch->policy->destroy(policy_state);
+    return NULL;
+}
+
+static int compare_int(const void *a, const void *b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static void batch_report(Batch *batch, double elapsed) {
+    int *scores = malloc(batch->ngames * sizeof *scores);
+    double score_sum = 0;
+    double tick_sum = 0;
+    int wins = 0;
+    int stalled = 0;
+    for (int i = 0; i < batch->ngames; i++) {
+        GameResult *result = &batch->results[i];
+        scores[i] = result->score;
+        score_sum += result->score;
+        tick_sum += result->ticks;
+        wins += result->won;
+        stalled += result->stalled;
+    }
+    qsort(scores, batch->ngames, sizeof *scores, compare_int);
+
+    int n = batch->ngames;
+    printf("policy     %s\n", batch->policy->name);
+    printf("board      %dx%d\n", batch->nlines, batch->ncols);
+    printf("games      %d\n", n);
+    printf("threads    %d\n", batch->nworkers);
+    printf("score      mean %.2f  p50 %d  p90 %d  p99 %d  max %d / %d\n",
+           score_sum / n, scores[n / 2], scores[n * 90 / 100],
+           scores[n * 99 / 100], scores[n - 1], batch->nlines * batch->ncols);
+    printf("ticks      mean %.1f  total %.0f\n", tick_sum / n, tick_sum);
+    printf("wins       %d (%.2f%%)\n", wins, 100.0 * wins / n);
+    printf("stalled    %d\n", stalled);
+    printf("elapsed    %.3f s\n", elapsed);
+    printf("games/sec  %.1f\n", n / elapsed);
+    printf("ticks/sec  %.0f\n", tick_sum / elapsed);
+
+    free(scores);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-n games] [-j threads] [-p policy] [-s seed] "
+            "[-t usec] [nlines [ncols]]\npolicies:",
+            prog);
+    for (Policy const *const *p = policy_all(); *p != NULL; p++) {
+        fprintf(stderr, " %s", (*p)->name);
+    }
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    Batch batch = {
+        .nlines = DEFAULT_LENGTH,
+        .ncols = DEFAULT_LENGTH,
+        .seed = time(NULL),
+        .policy = policy_find("greedy"),
+        .ngames = DEFAULT_GAMES,
+        .nworkers = sysconf(_SC_NPROCESSORS_ONLN),
+    };
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:j:p:s:t:")) != -1) {
+        switch (opt) {
+        case 'n':
+            batch.ngames = strtol(optarg, NULL, 0);
+            break;
+        case 'j':
+            batch.nworkers = strtol(optarg, NULL, 0);
+            break;
+        case 'p':
+            batch.policy = policy_find(optarg);
+            break;
+        case 's':
+            batch.seed = strtoull(optarg, NULL, 0);
+            break;
+        case 't':
+            batch.budget_ns = strtoll(optarg, NULL, 0) * 1000;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (argc - optind >= 1) {
+        batch.nlines = strtol(argv[optind], NULL, 0);
+        batch.ncols = batch.nlines;
+    }
+    if (argc - optind >= 2) {
+        batch.ncols = strtol(argv[optind + 1], NULL, 0);
+    }
+    if (batch.policy == NULL || batch.ngames <= 0 || batch.nlines <= 0 ||
+        batch.ncols <= 0 || argc - optind > 2) {
+        usage(argv[0]);
+    }
+    if (batch.nworkers <= 0) {
+        batch.nworkers = 1;
+    }
+    if (batch.nworkers > batch.ngames) {
+        batch.nworkers = batch.ngames;
+    }
+    // some policies cannot play every board; a first state up front also
+    // fills any cache the workers would otherwise race to fill
+    void *probe = batch.policy->create(batch.nlines, batch.ncols, batch.seed);
+    if (probe == NULL) {
+        fprintf(stderr, "%s cannot play a %dx%d board\n", batch.policy->name,
+                batch.nlines, batch.ncols);
+        exit(1);
+    }
+    batch.policy->destroy(probe);
+
+    batch.ranges = malloc(batch.nworkers * sizeof *batch.ranges);
+    batch.results = calloc(batch.ngames, sizeof *batch.results);
+    Worker *workers = malloc(batch.nworkers * sizeof *workers);
+    if (batch.ranges == NULL || batch.results == NULL || workers == NULL) {
+        fprintf(stderr, "%s\n", snake_error_str(SNAKE_ERROR_alloc));
+        exit(1);
+    }
+    for (int i = 0; i < batch.nworkers; i++) {
+        atomic_init(&batch.ranges[i].next,
+                    (int)((long)batch.ngames * i / batch.nworkers));
+        batch.ranges[i].end =
+            (int)((long)batch.ngames * (i + 1) / batch.nworkers);
+    }
+
+    int64_t start_ns = timer_now_ns();
+    for (int i = 0; i < batch.nworkers; i++) {
+        workers[i] = (Worker){.batch = &batch, .id = i};
+        if (pthread_create(&workers[i].thread, NULL, batch_worker,
+                           &workers[i]) != 0) {
+            fprintf(stderr, "could not start worker %d\n", i);
+            exit(1);
+        }
+    }
+    for (int i = 0; i < batch.nworkers; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    double elapsed = (timer_now_ns() - start_ns) / 1e9;
+
+    batch_report(&batch, elapsed);
+
+    free(workers);
+    free(batch.ranges);
+    free(batch.results);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,892 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "alloccount.h"
+#include "bitboard.h"
+#include "deque.h"
+#include "hamcycle.h"
+#include "mcts.h"
+#include "policy.h"
+#include "replay.h"
+#include "snakecore.h"
+#include "timer.h"
+#include "vecenv.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// each benchmark doubles its iteration count until one run takes this long
+#define BENCH_MIN_NS 200000000LL
+#define BENCH_SEED 42
+// choices the search benchmark makes, each a full budget long
+#define MCTS_BENCH_CHOICES 200
+// games stepped together, and action arrays cycled through, by the
+// vectorized stepping benchmark
+#define VECENV_BENCH_GAMES 1024
+#define VECENV_BENCH_ACTIONS 16
+// the allocation check plays this many ticks after a warm up game
+#define CHECK_TICKS 10000000L
+// the vecenv check steps this many games this many times per board
+#define VECENV_CHECK_GAMES 64
+#define VECENV_CHECK_STEPS 20000
+// the replay check records a soak this many ticks long, then seeks back into
+// it this many times
+#define REPLAY_CHECK_TICKS 100000L
+#define REPLAY_CHECK_SEEKS 1000
+
+typedef void (*BenchFn)(void *ctx, long iters);
+
+// prints one tab separated row: name, ns/op, allocations/op, ops
+static void bench_run(const char *name, BenchFn fn, void *ctx) {
+    for (long iters = 1;; iters *= 2) {
+        AllocCount before = alloccount_get();
+        int64_t start = timer_now_ns();
+        fn(ctx, iters);
+        int64_t elapsed = timer_now_ns() - start;
+        AllocCount after = alloccount_get();
+
+        if (elapsed >= BENCH_MIN_NS) {
+            printf("%s\t%.2f\t%.4f\t%ld\n", name, (double)elapsed / iters,
+                   (double)(after.allocs - before.allocs) / iters, iters);
+            fflush(stdout);
+            return;
+        }
+    }
+}
+
+static void bench_deque_churn(void *ctx, long iters) {
+    Deque *deq = ctx;
+    for (long i = 0; i < iters; i++) {
+        deque_push_front(deq, (Pose){.y = i & 0xff, .x = i >> 8 & 0xff});
+        deque_pop_back(deq);
+    }
+}
+
+static volatile bool bench_sink;
+
+static void bench_deque_contains(void *ctx, long iters) {
+    Deque *deq = ctx;
+    for (long i = 0; i < iters; i++) {
+        // never present, so every call walks the whole deque
+        bench_sink = deque_contains(deq, (Pose){.y = -2, .x = -2});
+    }
+}
+
+static void bench_food(void *ctx, long iters) {
+    Snake *snake = ctx;
+    Pose pos;
+    for (long i = 0; i < iters; i++) {
+        snake_find_food_pos(snake, &pos);
+    }
+    bench_sink = pos.x == pos.y;
+}
+
+// a closed tour of the largest even sized sub-board, so the snake can
+// tick forever: column 0 runs back up, the other columns are swept in rows
+typedef struct Cycle {
+    Pose *cells;
+    int length;
+    enum DIRECTION *dir;
+} Cycle;
+
+static Cycle bench_cycle(int nlines, int ncols) {
+    int h = nlines & ~1;
+    int w = ncols;
+    Cycle cycle = {
+        .cells = malloc(h * w * sizeof *cycle.cells),
+        .length = 0,
+        .dir = malloc(nlines * ncols * sizeof *cycle.dir),
+    };
+    for (int y = 0; y < h; y++) {
+        for (int i = 0; i < w - 1; i++) {
+            int x = y % 2 == 0 ? i + 1 : w - 1 - i;
+            cycle.cells[cycle.length++] = (Pose){.y = y, .x = x};
+        }
+    }
+    for (int y = h - 1; y >= 0; y--) {
+        cycle.cells[cycle.length++] = (Pose){.y = y, .x = 0};
+    }
+
+    for (int i = 0; i < nlines * ncols; i++) {
+        cycle.dir[i] = DIRECTION_null;
+    }
+    for (int i = 0; i < cycle.length; i++) {
+        Pose a = cycle.cells[i];
+        Pose b = cycle.cells[(i + 1) % cycle.length];
+        enum DIRECTION d = b.x < a.x   ? DIRECTION_left
+                           : b.x > a.x ? DIRECTION_right
+                           : b.y < a.y ? DIRECTION_up
+                                       : DIRECTION_down;
+        cycle.dir[a.y * ncols + a.x] = d;
+    }
+    return cycle;
+}
+
+typedef struct TickBench {
+    Snake *snake;
+    Cycle cycle;
+    Pose *body;
+    int body_length;
+} TickBench;
+
+static void tick_bench_reset(TickBench *bench) {
+    snake_set_body(bench->snake, bench->body, bench->body_length);
+}
+
+static void bench_tick(void *ctx, long iters) {
+    TickBench *bench = ctx;
+    Snake *snake = bench->snake;
+    for (long i = 0; i < iters; i++) {
+        if (snake->state == STATE_win || snake->state == STATE_lose) {
+            tick_bench_reset(bench);
+        }
+        Pose head = snake_get_head(snake);
+        snake_set_direction(snake,
+                            bench->cycle.dir[head.y * snake->ncols + head.x]);
+        snake_update(snake);
+        snake_clear_dirty(snake);
+    }
+}
+
+static void run_deque_benches(void) {
+    char name[64];
+
+    Deque *deq = deque_new(101);
+    for (int i = 0; i < 100; i++) {
+        deque_push_back(deq, (Pose){.y = i, .x = i});
+    }
+    bench_run("deque_churn/len=100", bench_deque_churn, deq);
+    deque_destroy(deq);
+
+    int lengths[] = {100, 1000, 10000};
+    for (size_t i = 0; i < sizeof lengths / sizeof lengths[0]; i++) {
+        deq = deque_new(lengths[i]);
+        // start mid ring so the walk covers both runs
+        for (int j = 0; j < lengths[i] / 2; j++) {
+            deque_push_back(deq, (Pose){0, 0});
+            deque_pop_front(deq);
+        }
+        for (int j = 0; j < lengths[i]; j++) {
+            deque_push_back(deq, (Pose){.y = j / 100, .x = j % 100});
+        }
+        snprintf(name, sizeof name, "deque_contains/len=%d", lengths[i]);
+        bench_run(name, bench_deque_contains, deq);
+        deque_destroy(deq);
+    }
+}
+
+static void run_food_benches(void) {
+    char name[64];
+    int nlines = 100;
+    int ncols = 100;
+    Cycle cycle = bench_cycle(nlines, ncols);
+    Snake *snake = snake_new(nlines, ncols, BENCH_SEED);
+
+    double fills[] = {0.10, 0.50, 0.90, 0.99};
+    for (size_t i = 0; i < sizeof fills / sizeof fills[0]; i++) {
+        snake_set_body(snake, cycle.cells, fills[i] * cycle.length);
+        snprintf(name, sizeof name, "find_food_pos/%dx%d/fill=%.2f", nlines,
+                 ncols, fills[i]);
+        bench_run(name, bench_food, snake);
+    }
+
+    snake_destroy(snake);
+    free(cycle.cells);
+    free(cycle.dir);
+}
+
+typedef struct ChooseBench {
+    Policy const *policy;
+    void *state;
+    Snake *snake;
+} ChooseBench;
+
+// a fresh decision each time: the policy forgets its plan first
+static void bench_choose(void *ctx, long iters) {
+    ChooseBench *bench = ctx;
+    enum DIRECTION dir = DIRECTION_null;
+    for (long i = 0; i < iters; i++) {
+        bench->policy->reset(bench->state, BENCH_SEED);
+        dir = bench->policy->choose(bench->state, bench->snake);
+    }
+    bench_sink = dir == DIRECTION_null;
+}
+
+typedef struct ReachBench {
+    Snake *snake;
+    // the cells neither method may enter, the snake's body or a maze
+    bool const *blocked;
+    Pose start;
+    // what the last run of either method reached, for checking them
+    int count;
+    // BFS scratch
+    bool *seen;
+    int *queue;
+    Bitboard *open;
+    Bitboard *reach;
+} ReachBench;
+
+// the baseline: a queue of cells, one neighbor at a time
+static void bench_reach_bfs(void *ctx, long iters) {
+    ReachBench *bench = ctx;
+    Snake *snake = bench->snake;
+    int ncols = snake->ncols;
+    int ncells = snake->nlines * ncols;
+    int count = 0;
+    for (long i = 0; i < iters; i++) {
+        memset(bench->seen, 0, ncells * sizeof *bench->seen);
+        int start = bench->start.y * ncols + bench->start.x;
+        int head = 0;
+        count = 0;
+        bench->queue[count++] = start;
+        bench->seen[start] = true;
+        while (head < count) {
+            int cell = bench->queue[head++];
+            Pose pos = {.y = cell / ncols, .x = cell % ncols};
+            for (enum DIRECTION d = DIRECTION_left; d <= DIRECTION_down; d++) {
+                Pose next = policy_step(pos, d);
+                int at = next.y * ncols + next.x;
+                if (snake_pos_out_of_bounds(snake, next) == false &&
+                    bench->blocked[at] == false && bench->seen[at] == false) {
+                    bench->seen[at] = true;
+                    bench->queue[count++] = at;
+                }
+            }
+        }
+    }
+    bench->count = count;
+    bench_sink = count == 0;
+}
+
+// the free cells as a bitboard kept alongside the game, so only the flood
+// is timed
+static void bench_reach_bitboard(void *ctx, long iters) {
+    ReachBench *bench = ctx;
+    int count = 0;
+    for (long i = 0; i < iters; i++) {
+        count = bitboard_reachable(bench->reach, bench->open, bench->start);
+    }
+    bench->count = count;
+    bench_sink = count == 0;
+}
+
+// the row steps the bitboard is timed with, where the CPU has them
+static char const *const bitboard_steps[] = {
+    [BITBOARD_STEP_scalar] = "scalar",
+    [BITBOARD_STEP_sse2] = "sse2",
+    [BITBOARD_STEP_avx2] = "avx2",
+};
+
+// times the BFS and the bitboard with each row step on the board as set up,
+// failing if any of them disagree
+static bool run_reach_pair(ReachBench *bench, char const *board) {
+    char name[64];
+    int n = bench->snake->nlines;
+    bitboard_clear(bench->open);
+    bitboard_set_free(bench->open, bench->blocked);
+
+    snprintf(name, sizeof name, "reach_bfs/%dx%d/%s", n, n, board);
+    bench_run(name, bench_reach_bfs, bench);
+    int expected = bench->count;
+    bool ok = true;
+    for (enum BITBOARD_STEP step = BITBOARD_STEP_scalar;
+         ok && step <= BITBOARD_STEP_avx2; step++) {
+        if (bitboard_use_step(step) == false) {
+            continue;
+        }
+        snprintf(name, sizeof name, "reach_bitboard/%dx%d/%s/%s", n, n,
+                 board, bitboard_steps[step]);
+        bench_run(name, bench_reach_bitboard, bench);
+        if (bench->count != expected) {
+            fprintf(stderr, "FAIL: %s reached %d cells, the BFS %d\n", name,
+                    bench->count, expected);
+            ok = false;
+        }
+    }
+    bitboard_use_step(BITBOARD_STEP_best);
+    return ok;
+}
+
+// the room left in front of the head, what a safety check asks; false if
+// the bitboard ever reaches a different number of cells than the BFS
+static bool run_reach_benches(void) {
+    char board[32];
+    int n = 200;
+    Cycle cycle = bench_cycle(n, n);
+    ReachBench bench = {
+        .snake = snake_new(n, n, BENCH_SEED),
+        .seen = malloc(n * n * sizeof *bench.seen),
+        .queue = malloc(n * n * sizeof *bench.queue),
+        .open = bitboard_new(n, n),
+        .reach = bitboard_new(n, n),
+    };
+    bool *maze = calloc(n * n, sizeof *maze);
+    bool ok = true;
+
+    double fills[] = {0.10, 0.50, 0.90};
+    for (size_t i = 0; ok && i < sizeof fills / sizeof fills[0]; i++) {
+        // the tour backwards, so the head leads into the free cells
+        int length = fills[i] * cycle.length;
+        Pose *body = malloc(length * sizeof *body);
+        for (int j = 0; j < length; j++) {
+            body[j] = cycle.cells[length - 1 - j];
+        }
+        snake_set_body(bench.snake, body, length);
+        bench.blocked = bench.snake->occupied;
+        bench.start = cycle.cells[length];
+        free(body);
+        snprintf(board, sizeof board, "fill=%.2f", fills[i]);
+        ok = run_reach_pair(&bench, board);
+    }
+
+    // a serpentine: walls down every other column, open at the bottom and
+    // the top in turn, so the only path runs the length of each corridor
+    // and a sweep down or up the rows gets through one corridor at a time
+    for (int x = 1; x < n; x += 2) {
+        for (int y = 0; y < n - 1; y++) {
+            maze[(x % 4 == 1 ? y : y + 1) * n + x] = true;
+        }
+    }
+    if (ok) {
+        bench.blocked = maze;
+        bench.start = (Pose){.y = 0, .x = 0};
+        ok = run_reach_pair(&bench, "maze");
+    }
+
+    snake_destroy(bench.snake);
+    free(bench.seen);
+    free(bench.queue);
+    free(maze);
+    bitboard_destroy(bench.open);
+    bitboard_destroy(bench.reach);
+    free(cycle.cells);
+    free(cycle.dir);
+    return ok;
+}
+
+// the autopilot's budget is one tick, 1 ms at the fastest default speeds
+static void run_policy_benches(void) {
+    char name[64];
+    int n = 200;
+    Cycle cycle = bench_cycle(n, n);
+    ChooseBench bench = {
+        .policy = policy_find("bfs"),
+        .state = policy_find("bfs")->create(n, n, BENCH_SEED),
+        .snake = snake_new(n, n, BENCH_SEED),
+    };
+
+    double fills[] = {0.10, 0.50, 0.90};
+    for (size_t i = 0; i < sizeof fills / sizeof fills[0]; i++) {
+        // the tour backwards, so the head leads into the free cells
+        int length = fills[i] * cycle.length;
+        Pose *body = malloc(length * sizeof *body);
+        for (int j = 0; j < length; j++) {
+            body[j] = cycle.cells[length - 1 - j];
+        }
+        snake_set_body(bench.snake, body, length);
+        snake_set_direction(bench.snake, cycle.dir[body[1].y * n + body[1].x]);
+        free(body);
+
+        snprintf(name, sizeof name, "bfs_choose/%dx%d/fill=%.2f", n, n,
+                 fills[i]);
+        bench_run(name, bench_choose, &bench);
+    }
+
+    bench.policy->destroy(bench.state);
+    snake_destroy(bench.snake);
+    free(cycle.cells);
+    free(cycle.dir);
+}
+
+// the search runs for a fixed time, so its row is per rollout: ns each
+// across all threads, allocations each, and how many ran; the rollouts a
+// choice gets are ops / MCTS_BENCH_CHOICES
+static void run_mcts_bench(int n) {
+    Cycle cycle = bench_cycle(n, n);
+    Snake *snake = snake_new(n, n, BENCH_SEED);
+    void *state = mcts_policy.create(n, n, BENCH_SEED);
+    int length = cycle.length / 10;
+    Pose *body = malloc(length * sizeof *body);
+    for (int j = 0; j < length; j++) {
+        body[j] = cycle.cells[length - 1 - j];
+    }
+    snake_set_body(snake, body, length);
+    snake_set_direction(snake, cycle.dir[body[1].y * n + body[1].x]);
+    free(body);
+    mcts_policy.set_budget(state, 1000000);
+
+    long rollouts = 0;
+    AllocCount before = alloccount_get();
+    int64_t start = timer_now_ns();
+    for (int i = 0; i < MCTS_BENCH_CHOICES; i++) {
+        mcts_policy.choose(state, snake);
+        rollouts += mcts_rollouts(state);
+    }
+    int64_t elapsed = timer_now_ns() - start;
+    AllocCount after = alloccount_get();
+    printf("mcts_rollout/%dx%d/fill=0.10/budget=1ms\t%.2f\t%.4f\t%ld\n", n,
+           n, (double)elapsed / rollouts,
+           (double)(after.allocs - before.allocs) / rollouts, rollouts);
+    fflush(stdout);
+
+    mcts_policy.destroy(state);
+    snake_destroy(snake);
+    free(cycle.cells);
+    free(cycle.dir);
+}
+
+static void run_mcts_benches(void) {
+    run_mcts_bench(10);
+    run_mcts_bench(50);
+}
+
+typedef struct VecEnvBench {
+    VecEnv *env;
+    uint8_t *actions;
+    long step;
+} VecEnvBench;
+
+// an op is one game's move; random moves, so games end and restart often
+static void bench_vecenv_step(void *ctx, long iters) {
+    VecEnvBench *bench = ctx;
+    for (long i = 0; i < iters; i += VECENV_BENCH_GAMES) {
+        int k = bench->step++ % VECENV_BENCH_ACTIONS;
+        vecenv_step(bench->env, bench->actions + k * VECENV_BENCH_GAMES);
+    }
+}
+
+static void run_vecenv_benches(void) {
+    char name[64];
+    int sizes[] = {10, 20, 50};
+    long nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    Rng rng;
+    rng_seed(&rng, BENCH_SEED);
+    VecEnvBench bench = {
+        .actions = malloc(VECENV_BENCH_ACTIONS * VECENV_BENCH_GAMES),
+    };
+    for (int i = 0; i < VECENV_BENCH_ACTIONS * VECENV_BENCH_GAMES; i++) {
+        bench.actions[i] = DIRECTION_left + rng_below(&rng, 4);
+    }
+
+    for (size_t i = 0; i < sizeof sizes / sizeof sizes[0]; i++) {
+        int n = sizes[i];
+        bench.env = vecenv_new(VECENV_BENCH_GAMES, n, n, BENCH_SEED,
+                               nthreads > 0 ? nthreads : 1);
+        size_t obs_size = vecenv_obs_size(bench.env);
+        uint8_t *obs = malloc(VECENV_BENCH_GAMES * obs_size);
+        float *rewards = malloc(VECENV_BENCH_GAMES * sizeof *rewards);
+        uint8_t *dones = malloc(VECENV_BENCH_GAMES);
+        vecenv_bind(bench.env, obs, rewards, dones);
+
+        snprintf(name, sizeof name, "vecenv_step/%dx%d/games=%d", n, n,
+                 VECENV_BENCH_GAMES);
+        bench_run(name, bench_vecenv_step, &bench);
+
+        vecenv_destroy(bench.env);
+        free(obs);
+        free(rewards);
+        free(dones);
+    }
+    free(bench.actions);
+}
+
+typedef struct CycleBench {
+    int n;
+    // NULL builds every time
+    const char *cache_dir;
+} CycleBench;
+
+static void bench_cycle_open(void *ctx, long iters) {
+    CycleBench *bench = ctx;
+    for (long i = 0; i < iters; i++) {
+        HamCycle *cycle = hamcycle_open(bench->n, bench->n, bench->cache_dir);
+        bench_sink = cycle->order[0] == 0;
+        hamcycle_close(cycle);
+    }
+}
+
+// what the hamilton policy costs before the first move, without and with
+// the cycle cache
+static void run_cycle_benches(void) {
+    char name[64];
+    char dir[] = "/tmp/snake-bench-XXXXXX";
+    char path[sizeof dir + 32];
+    if (mkdtemp(dir) == NULL) {
+        return;
+    }
+    int n = 200;
+    CycleBench bench = {.n = n, .cache_dir = NULL};
+    snprintf(name, sizeof name, "hamcycle_build/%dx%d", n, n);
+    bench_run(name, bench_cycle_open, &bench);
+
+    bench.cache_dir = dir;
+    hamcycle_close(hamcycle_open(n, n, dir));
+    snprintf(name, sizeof name, "hamcycle_open/%dx%d/cached", n, n);
+    bench_run(name, bench_cycle_open, &bench);
+
+    snprintf(path, sizeof path, "%s/cycle-%dx%d", dir, n, n);
+    unlink(path);
+    rmdir(dir);
+}
+
+static void run_tick_benches(void) {
+    char name[64];
+    int sizes[] = {15, 50, 100, 200, 500};
+    for (size_t i = 0; i < sizeof sizes / sizeof sizes[0]; i++) {
+        int n = sizes[i];
+        TickBench bench = {
+            .snake = snake_new(n, n, BENCH_SEED),
+            .cycle = bench_cycle(n, n),
+        };
+        // half the tour, listed head first
+        bench.body_length = bench.cycle.length / 2;
+        bench.body = malloc(bench.body_length * sizeof *bench.body);
+        for (int j = 0; j < bench.body_length; j++) {
+            bench.body[j] = bench.cycle.cells[bench.body_length - 1 - j];
+        }
+        tick_bench_reset(&bench);
+
+        snprintf(name, sizeof name, "snake_update/%dx%d", n, n);
+        bench_run(name, bench_tick, &bench);
+
+        snake_destroy(bench.snake);
+        free(bench.cycle.cells);
+        free(bench.cycle.dir);
+        free(bench.body);
+    }
+}
+
+// plays games back to back on one snake, following the tour with random
+// flips that end games early so restarts happen often, and counts what was
+// allocated and freed after the first game; nonzero if anything was
+static int check_allocs(void) {
+    int n = 50;
+    Cycle cycle = bench_cycle(n, n);
+    Snake *snake = snake_new(n, n, BENCH_SEED);
+    // the first counted game is steered by the autopilot's policy, a long
+    // one that replans on every meal and flip
+    Policy const *pilot = policy_find("bfs");
+    void *pilot_state = pilot->create(n, n, BENCH_SEED);
+    Rng rng;
+    rng_seed(&rng, BENCH_SEED);
+
+    AllocCount before = alloccount_get();
+    long games = 0;
+    for (long tick = 0; tick < CHECK_TICKS; tick++) {
+        if (snake->state == STATE_win || snake->state == STATE_lose) {
+            if (games++ == 0) {
+                before = alloccount_get();
+            }
+            snake_reset(snake, rng_next(&snake->rng));
+            pilot->reset(pilot_state, games);
+        }
+        Pose head = snake_get_head(snake);
+        if (rng_below(&rng, 256) == 0) {
+            snake_flip(snake);
+        } else if (games == 1) {
+            snake_set_direction(snake, pilot->choose(pilot_state, snake));
+        } else {
+            snake_set_direction(snake, cycle.dir[head.y * n + head.x]);
+        }
+        snake_update(snake);
+        snake_clear_dirty(snake);
+    }
+    AllocCount after = alloccount_get();
+
+    pilot->destroy(pilot_state);
+    snake_destroy(snake);
+    free(cycle.cells);
+    free(cycle.dir);
+
+    uint64_t allocs = after.allocs - before.allocs;
+    uint64_t frees = after.frees - before.frees;
+    printf("ticks      %ld\n", CHECK_TICKS);
+    printf("games      %ld\n", games);
+    printf("allocs     %llu (%.4f/tick)\n", (unsigned long long)allocs,
+           (double)allocs / CHECK_TICKS);
+    printf("frees      %llu (%.4f/tick)\n", (unsigned long long)frees,
+           (double)frees / CHECK_TICKS);
+    if (games == 0 || allocs > 0 || frees > 0) {
+        printf("FAIL: steady state play %s\n",
+               games == 0 ? "never restarted" : "touched the allocator");
+        return EXIT_FAILURE;
+    }
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
+
+// what vecenv_step should make of one game: the reference Snake moved by
+// snake_update, then the reward and done the header promises for it
+static void check_vecenv_move(Snake *ref, int *since_food, uint8_t action,
+                              float *reward, uint8_t *done) {
+    int ncells = ref->nlines * ref->ncols;
+    int length = ref->deq->length;
+    if (action != DIRECTION_null) {
+        snake_set_direction(ref, action);
+    }
+    snake_update(ref);
+    snake_clear_dirty(ref);
+    *reward = 0;
+    *done = VECENV_DONE_none;
+    if (ref->state == STATE_lose) {
+        *reward = -1;
+        *done = VECENV_DONE_lose;
+    } else if (ref->state == STATE_win) {
+        *reward = 1;
+        *done = VECENV_DONE_win;
+    } else if (ref->deq->length != length) {
+        *reward = 1;
+        *since_food = 0;
+    } else if (++*since_food > (long)ncells * SNAKE_STALL_TICKS_PER_CELL) {
+        *done = VECENV_DONE_stalled;
+    }
+    if (*done != VECENV_DONE_none) {
+        snake_reset(ref, rng_next(&ref->rng));
+        *since_food = 0;
+    }
+}
+
+// true if the game, and the obs written for it, are the reference's
+static bool check_vecenv_game(Snake const *game, uint8_t const *obs,
+                              Snake const *ref) {
+    int ncells = ref->nlines * ref->ncols;
+    Pose head = snake_get_head(ref);
+    if (pose_equal(snake_get_head(game), head) == false ||
+        pose_equal(game->food_pos, ref->food_pos) == false ||
+        game->deq->length != ref->deq->length ||
+        memcmp(game->occupied, ref->occupied,
+               ncells * sizeof *ref->occupied) != 0) {
+        return false;
+    }
+    for (int cell = 0; cell < ncells; cell++) {
+        Pose pos = {.y = cell / ref->ncols, .x = cell % ref->ncols};
+        if (obs[VECENV_PLANE_body * ncells + cell] != ref->occupied[cell] ||
+            obs[VECENV_PLANE_head * ncells + cell] != pose_equal(pos, head) ||
+            obs[VECENV_PLANE_food * ncells + cell] !=
+                pose_equal(pos, ref->food_pos)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// steps the games on three threads, half with random actions, beside a plain
+// Snake per game seeded the way vecenv_new seeds them, and checks every
+// step's obs, rewards and dones against the references; counts[done] adds
+// up the dones, counts[0] the meals
+static bool check_vecenv_board(int nlines, int ncols, long *counts) {
+    int ngames = VECENV_CHECK_GAMES;
+    VecEnv *env = vecenv_new(ngames, nlines, ncols, BENCH_SEED, 3);
+    size_t obs_size = vecenv_obs_size(env);
+    uint8_t *obs = malloc(ngames * obs_size);
+    float *rewards = malloc(ngames * sizeof *rewards);
+    uint8_t *dones = malloc(ngames);
+    uint8_t *actions = malloc(ngames);
+    Snake **refs = malloc(ngames * sizeof *refs);
+    int *since_food = calloc(ngames, sizeof *since_food);
+    Rng rng;
+    rng_seed(&rng, BENCH_SEED);
+    for (int i = 0; i < ngames; i++) {
+        refs[i] = snake_new(nlines, ncols, rng_next(&rng));
+    }
+    vecenv_bind(env, obs, rewards, dones);
+
+    uint8_t const circle[4] = {DIRECTION_right, DIRECTION_down, DIRECTION_left,
+                               DIRECTION_up};
+    bool ok = true;
+    for (int step = 0; ok && step < VECENV_CHECK_STEPS; step++) {
+        // the odd games turn the same way every move, circling a square
+        // until they stall or starve into one
+        for (int i = 0; i < ngames; i++) {
+            actions[i] = i % 2 == 0 ? rng_below(&rng, DIRECTION_down + 1)
+                                    : circle[step % 4];
+        }
+        vecenv_step(env, actions);
+        for (int i = 0; ok && i < ngames; i++) {
+            float reward;
+            uint8_t done;
+            check_vecenv_move(refs[i], &since_food[i], actions[i], &reward,
+                              &done);
+            ok = rewards[i] == reward && dones[i] == done &&
+                 check_vecenv_game(vecenv_game(env, i), obs + i * obs_size,
+                                   refs[i]);
+            if (ok == false) {
+                printf("FAIL: %dx%d game %d step %d: reward %g done %d, "
+                       "expected %g and %d\n",
+                       nlines, ncols, i, step, rewards[i], dones[i], reward,
+                       done);
+            }
+            counts[0] += done == VECENV_DONE_none && reward > 0;
+            counts[done] += done != VECENV_DONE_none;
+        }
+    }
+
+    for (int i = 0; i < ngames; i++) {
+        snake_destroy(refs[i]);
+    }
+    vecenv_destroy(env);
+    free(obs);
+    free(rewards);
+    free(dones);
+    free(actions);
+    free(refs);
+    free(since_food);
+    return ok;
+}
+
+// vecenv against plain Snakes on a roomy board, a narrow one and one a
+// single meal wins; nonzero if any step differs
+static int check_vecenv(void) {
+    int boards[][2] = {{8, 8}, {3, 11}, {1, 2}};
+    for (size_t i = 0; i < sizeof boards / sizeof boards[0]; i++) {
+        long counts[VECENV_DONE_stalled + 1] = {0};
+        if (check_vecenv_board(boards[i][0], boards[i][1], counts) == false) {
+            return EXIT_FAILURE;
+        }
+        printf("%dx%-3d meals %-7ld lost %-7ld won %-7ld stalled %ld\n",
+               boards[i][0], boards[i][1], counts[0],
+               counts[VECENV_DONE_lose], counts[VECENV_DONE_win],
+               counts[VECENV_DONE_stalled]);
+    }
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
+
+// records a soak the way the controller does: random turns, speed changes
+// and restarts that keep the current speed; returns the live delay in effect
+// during each tick through delays, false if the file could not be written
+static bool check_replay_record(const char *path, int n, uint32_t *delays) {
+    ReplayHeader header = {
+        .nlines = n,
+        .ncols = n,
+        .seed = BENCH_SEED,
+        .delay_us = 100000,
+        .keyframe_interval = 256,
+    };
+    ReplayWriter *writer = replay_writer_open(path, &header);
+    if (writer == NULL) {
+        return false;
+    }
+    Snake *live = snake_new(n, n, BENCH_SEED);
+    Rng rng;
+    rng_seed(&rng, BENCH_SEED);
+    uint32_t delay_us = header.delay_us;
+    bool ok = true;
+    for (int64_t tick = 0; ok && tick < REPLAY_CHECK_TICKS; tick++) {
+        if (live->state == STATE_win || live->state == STATE_lose) {
+            snake_reset(live, rng_next(&live->rng));
+            ok &= replay_writer_event(writer, tick, REPLAY_EVENT_restart, 0);
+            ok &= replay_writer_event(writer, tick, REPLAY_EVENT_delay,
+                                      delay_us);
+        }
+        if (rng_below(&rng, 64) == 0) {
+            delay_us = 1000 * (1 + rng_below(&rng, 200));
+            ok &= replay_writer_event(writer, tick, REPLAY_EVENT_delay,
+                                      delay_us);
+        }
+        // a fresh game waits for its first turn
+        if (live->state != STATE_active || rng_below(&rng, 4) == 0) {
+            enum DIRECTION dir = DIRECTION_left + rng_below(&rng, 4);
+            snake_set_direction(live, dir);
+            ok &= replay_writer_event(writer, tick, (enum REPLAY_EVENT)dir, 0);
+        }
+        delays[tick] = delay_us;
+        snake_update(live);
+        snake_clear_dirty(live);
+        ok &= replay_writer_tick(writer, tick + 1, live);
+    }
+    snake_destroy(live);
+    return replay_writer_close(writer) && ok;
+}
+
+// a soak's replay against the delays it was recorded with, played straight
+// through and then seeked around so keyframes are restored too; nonzero if
+// the player is ever on a different speed than the live game was
+static int check_replay(void) {
+    int n = 8;
+    char path[] = "/tmp/snake-bench-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return EXIT_FAILURE;
+    }
+    close(fd);
+    uint32_t *delays = malloc(REPLAY_CHECK_TICKS * sizeof *delays);
+    bool recorded = check_replay_record(path, n, delays);
+    ReplayReader *reader = recorded ? replay_reader_open(path) : NULL;
+    unlink(path);
+    if (reader == NULL) {
+        printf("FAIL: could not %s %s\n", recorded ? "read" : "write", path);
+        free(delays);
+        return EXIT_FAILURE;
+    }
+
+    Snake *model = snake_new(n, n, BENCH_SEED);
+    ReplayPlayer player;
+    replay_player_init(&player, reader, model);
+    int64_t mismatch = -1;
+    while (mismatch < 0 && player.tick < REPLAY_CHECK_TICKS &&
+           replay_player_step(&player)) {
+        snake_clear_dirty(model);
+        if (player.delay_us != delays[player.tick - 1]) {
+            mismatch = player.tick - 1;
+        }
+    }
+    int games = player.games;
+    bool finished = player.tick == REPLAY_CHECK_TICKS;
+    Rng rng;
+    rng_seed(&rng, BENCH_SEED);
+    for (int i = 0; mismatch < 0 && finished && i < REPLAY_CHECK_SEEKS; i++) {
+        int64_t tick = 1 + rng_below(&rng, REPLAY_CHECK_TICKS);
+        finished = replay_player_seek(&player, tick);
+        snake_clear_dirty(model);
+        if (player.delay_us != delays[tick - 1]) {
+            mismatch = tick - 1;
+        }
+    }
+    snake_destroy(model);
+    replay_reader_close(reader);
+
+    printf("ticks      %ld\n", REPLAY_CHECK_TICKS);
+    printf("games      %d\n", games);
+    printf("seeks      %d\n", REPLAY_CHECK_SEEKS);
+    if (mismatch >= 0) {
+        printf("FAIL: tick %lld played at %u us, recorded at %u us\n",
+               (long long)mismatch, player.delay_us, delays[mismatch]);
+    } else if (finished == false || games < 2) {
+        printf("FAIL: the replay %s\n",
+               finished ? "never restarted" : "ended early");
+    }
+    free(delays);
+    if (mismatch >= 0 || finished == false || games < 2) {
+        return EXIT_FAILURE;
+    }
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc == 2 && strcmp(argv[1], "--allocs") == 0) {
+        return check_allocs();
+    } else if (argc == 2 && strcmp(argv[1], "--vecenv") == 0) {
+        return check_vecenv();
+    } else if (argc == 2 && strcmp(argv[1], "--replay") == 0) {
+        return check_replay();
+    } else if (argc > 1) {
+        fprintf(stderr, "usage: %s [--allocs | --vecenv | --replay]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+    printf("benchmark\tns_per_op\tallocs_per_op\tops\n");
+    run_deque_benches();
+    run_food_benches();
+    run_tick_benches();
+    run_vecenv_benches();
+    if (run_reach_benches() == false) {
+        return EXIT_FAILURE;
+    }
+    run_policy_benches();
+    run_mcts_benches();
+    run_cycle_benches();
+    return EXIT_SUCCESS;
+}
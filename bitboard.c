@@ -0,0 +1,348 @@
+#include <stdlib.h>
+#include <string.h>
+#include "bitboard.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BITBOARD_X86 1
+#include <immintrin.h>
+#endif
+
+// words per vector, what the stride is rounded to
+#define BITBOARD_STRIDE_ALIGN 4
+
+// one step of a row's flood: the cells below or above that are open, then
+// every run of open cells within a word that holds one of them
+typedef void (*BitboardRowStep)(uint64_t *row, uint64_t const *from,
+                                uint64_t const *open, int stride);
+
+static int
+bitboard_stride(int ncols)
+{
+    int words = (ncols + 63) / 64;
+    return (words + BITBOARD_STRIDE_ALIGN - 1) / BITBOARD_STRIDE_ALIGN *
+           BITBOARD_STRIDE_ALIGN;
+}
+
+size_t
+bitboard_words(int nlines, int ncols)
+{
+    return (size_t) nlines * bitboard_stride(ncols);
+}
+
+Bitboard *
+bitboard_new(int nlines, int ncols)
+{
+    Bitboard *board = malloc(sizeof *board);
+    if (board == NULL)
+    {
+        return NULL;
+    }
+    uint64_t *bits = malloc(bitboard_words(nlines, ncols) * sizeof *bits);
+    if (bits == NULL)
+    {
+        free(board);
+        return NULL;
+    }
+    bitboard_init(board, bits, nlines, ncols);
+    return board;
+}
+
+void
+bitboard_init(Bitboard *board, uint64_t *bits, int nlines, int ncols)
+{
+    board->nlines = nlines;
+    board->ncols = ncols;
+    board->stride = bitboard_stride(ncols);
+    board->bits = bits;
+    bitboard_clear(board);
+}
+
+void
+bitboard_destroy(Bitboard *board)
+{
+    free(board->bits);
+    free(board);
+}
+
+void
+bitboard_clear(Bitboard *board)
+{
+    memset(board->bits, 0,
+           bitboard_words(board->nlines, board->ncols) * sizeof *board->bits);
+}
+
+void
+bitboard_set_free(Bitboard *board, bool const *occupied)
+{
+    for (int y = 0; y < board->nlines; y++)
+    {
+        uint64_t *row = board->bits + (size_t) y * board->stride;
+        bool const *cells = occupied + (size_t) y * board->ncols;
+        for (int x = 0; x < board->ncols; x++)
+        {
+            row[x >> 6] |= (uint64_t) !cells[x] << (x & 63);
+        }
+    }
+}
+
+static uint64_t *
+bitboard_word(Bitboard const *board, Pose pos)
+{
+    return board->bits + (size_t) pos.y * board->stride + (pos.x >> 6);
+}
+
+void
+bitboard_set(Bitboard *board, Pose pos)
+{
+    *bitboard_word(board, pos) |= (uint64_t) 1 << (pos.x & 63);
+}
+
+void
+bitboard_unset(Bitboard *board, Pose pos)
+{
+    *bitboard_word(board, pos) &= ~((uint64_t) 1 << (pos.x & 63));
+}
+
+bool
+bitboard_test(Bitboard const *board, Pose pos)
+{
+    return *bitboard_word(board, pos) >> (pos.x & 63) & 1;
+}
+
+int
+bitboard_count(Bitboard const *board)
+{
+    size_t words = bitboard_words(board->nlines, board->ncols);
+    int count = 0;
+    for (size_t i = 0; i < words; i++)
+    {
+        count += __builtin_popcountll(board->bits[i]);
+    }
+    return count;
+}
+
+// the open cells joined to g within the word toward the high bits, in
+// doubling steps instead of one per cell
+static uint64_t
+bitboard_fill_up(uint64_t g, uint64_t p)
+{
+    g |= p & (g << 1);
+    p &= p << 1;
+    g |= p & (g << 2);
+    p &= p << 2;
+    g |= p & (g << 4);
+    p &= p << 4;
+    g |= p & (g << 8);
+    p &= p << 8;
+    g |= p & (g << 16);
+    p &= p << 16;
+    return g | (p & (g << 32));
+}
+
+static uint64_t
+bitboard_fill_down(uint64_t g, uint64_t p)
+{
+    g |= p & (g >> 1);
+    p &= p >> 1;
+    g |= p & (g >> 2);
+    p &= p >> 2;
+    g |= p & (g >> 4);
+    p &= p >> 4;
+    g |= p & (g >> 8);
+    p &= p >> 8;
+    g |= p & (g >> 16);
+    p &= p >> 16;
+    return g | (p & (g >> 32));
+}
+
+#ifdef BITBOARD_X86
+
+// bitboard_fill_up and bitboard_fill_down on every lane of g, a vector of
+// type T, with that vector's OR, AND and shifts, leaving both fills in g
+#define BITBOARD_FILL(T, g, o, OR, AND, SHL, SHR)                            \
+    do                                                                       \
+    {                                                                        \
+        T up_ = (g);                                                         \
+        T down_ = (g);                                                       \
+        T pu_ = (o);                                                         \
+        T pd_ = (o);                                                         \
+        for (int n_ = 1; n_ < 64; n_ *= 2)                                   \
+        {                                                                    \
+            __m128i count_ = _mm_cvtsi32_si128(n_);                          \
+            up_ = OR(up_, AND(pu_, SHL(up_, count_)));                       \
+            pu_ = AND(pu_, SHL(pu_, count_));                                \
+            down_ = OR(down_, AND(pd_, SHR(down_, count_)));                 \
+            pd_ = AND(pd_, SHR(pd_, count_));                                \
+        }                                                                    \
+        (g) = OR(up_, down_);                                                \
+    } while (0)
+
+// two words at a time; every x86-64 has SSE2
+static void
+bitboard_row_step_sse2(uint64_t *row, uint64_t const *from,
+                       uint64_t const *open, int stride)
+{
+    for (int w = 0; w < stride; w += 2)
+    {
+        __m128i o = _mm_loadu_si128((__m128i const *) (open + w));
+        __m128i g = _mm_or_si128(
+            _mm_loadu_si128((__m128i const *) (row + w)),
+            _mm_and_si128(_mm_loadu_si128((__m128i const *) (from + w)), o));
+        BITBOARD_FILL(__m128i, g, o, _mm_or_si128, _mm_and_si128,
+                      _mm_sll_epi64, _mm_srl_epi64);
+        _mm_storeu_si128((__m128i *) (row + w), g);
+    }
+}
+
+// four at a time where the CPU has AVX2
+__attribute__((target("avx2"))) static void
+bitboard_row_step_avx2(uint64_t *row, uint64_t const *from,
+                       uint64_t const *open, int stride)
+{
+    for (int w = 0; w < stride; w += 4)
+    {
+        __m256i o = _mm256_loadu_si256((__m256i const *) (open + w));
+        __m256i g = _mm256_or_si256(
+            _mm256_loadu_si256((__m256i const *) (row + w)),
+            _mm256_and_si256(
+                _mm256_loadu_si256((__m256i const *) (from + w)), o));
+        BITBOARD_FILL(__m256i, g, o, _mm256_or_si256, _mm256_and_si256,
+                      _mm256_sll_epi64, _mm256_srl_epi64);
+        _mm256_storeu_si256((__m256i *) (row + w), g);
+    }
+}
+
+#endif // BITBOARD_X86
+
+// one word at a time, on any CPU
+static void
+bitboard_row_step_scalar(uint64_t *row, uint64_t const *from,
+                         uint64_t const *open, int stride)
+{
+    for (int w = 0; w < stride; w++)
+    {
+        uint64_t g = row[w] | (from[w] & open[w]);
+        row[w] = bitboard_fill_up(g, open[w]) | bitboard_fill_down(g, open[w]);
+    }
+}
+
+// set by bitboard_use_step, NULL for the fastest the CPU has
+static BitboardRowStep bitboard_chosen_step;
+
+static BitboardRowStep
+bitboard_row_step(void)
+{
+    if (bitboard_chosen_step != NULL)
+    {
+        return bitboard_chosen_step;
+    }
+#ifdef BITBOARD_X86
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return bitboard_row_step_avx2;
+    }
+    return bitboard_row_step_sse2;
+#else
+    return bitboard_row_step_scalar;
+#endif
+}
+
+bool
+bitboard_use_step(enum BITBOARD_STEP step)
+{
+    BitboardRowStep chosen;
+    switch (step)
+    {
+    case BITBOARD_STEP_best:
+        chosen = NULL;
+        break;
+    case BITBOARD_STEP_scalar:
+        chosen = bitboard_row_step_scalar;
+        break;
+#ifdef BITBOARD_X86
+    case BITBOARD_STEP_sse2:
+        chosen = bitboard_row_step_sse2;
+        break;
+    case BITBOARD_STEP_avx2:
+        if (__builtin_cpu_supports("avx2") == false)
+        {
+            return false;
+        }
+        chosen = bitboard_row_step_avx2;
+        break;
+#endif // BITBOARD_X86
+    default:
+        return false;
+    }
+    bitboard_chosen_step = chosen;
+    return true;
+}
+
+// runs that cross into the next word carry on through it, both ways
+static void
+bitboard_row_carry(uint64_t *row, uint64_t const *open, int words)
+{
+    for (int w = 1; w < words; w++)
+    {
+        uint64_t in = row[w - 1] >> 63 & open[w] & ~row[w] & 1;
+        if (in != 0)
+        {
+            row[w] = bitboard_fill_up(row[w] | in, open[w]);
+        }
+    }
+    for (int w = words - 2; w >= 0; w--)
+    {
+        uint64_t in = (row[w + 1] & 1) << 63 & open[w] & ~row[w];
+        if (in != 0)
+        {
+            row[w] = bitboard_fill_down(row[w] | in, open[w]);
+        }
+    }
+}
+
+// sweeps down the board and back up, each row taking what the one before
+// it reached, until a round trip adds nothing
+int
+bitboard_flood(Bitboard *reach, Bitboard const *open)
+{
+    BitboardRowStep step = bitboard_row_step();
+    int stride = reach->stride;
+    int words = (reach->ncols + 63) / 64;
+    uint64_t *r = reach->bits;
+    uint64_t const *o = open->bits;
+    int count = bitboard_count(reach);
+
+    while (true)
+    {
+        for (int y = 0; y < reach->nlines; y++)
+        {
+            size_t at = (size_t) y * stride;
+            step(r + at, y > 0 ? r + at - stride : r + at, o + at, stride);
+            bitboard_row_carry(r + at, o + at, words);
+        }
+        for (int y = reach->nlines - 2; y >= 0; y--)
+        {
+            size_t at = (size_t) y * stride;
+            step(r + at, r + at + stride, o + at, stride);
+            bitboard_row_carry(r + at, o + at, words);
+        }
+        int next = bitboard_count(reach);
+        if (next == count)
+        {
+            return count;
+        }
+        count = next;
+    }
+}
+
+int
+bitboard_reachable(Bitboard *reach, Bitboard const *open, Pose start)
+{
+    bitboard_clear(reach);
+    if (bitboard_test(open, start) == false)
+    {
+        return 0;
+    }
+    bitboard_set(reach, start);
+    return bitboard_flood(reach, open);
+}
@@ -0,0 +1,82 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "deque.h"
+
+// A board packed one bit per cell: row y is stride 64 bit words from
+// bits[y * stride], cell x at bit x % 64 of word x / 64. The stride is
+// rounded up to 4 words so a row is whole 256 bit vectors; the bits past
+// ncols stay clear.
+typedef struct Bitboard
+{
+    int nlines;
+    int ncols;
+    int stride;
+    uint64_t *bits;
+}
+Bitboard;
+
+// words a board of this size needs, for bitboard_init
+size_t
+bitboard_words(int nlines, int ncols);
+
+// returns NULL if the board could not be allocated
+Bitboard *
+bitboard_new(int nlines, int ncols);
+
+// sets up a cleared board on storage the caller owns, bitboard_words long
+void
+bitboard_init(Bitboard *board, uint64_t *bits, int nlines, int ncols);
+
+void
+bitboard_destroy(Bitboard *board);
+
+void
+bitboard_clear(Bitboard *board);
+
+// sets the cells whose entry in occupied, row major, is false
+void
+bitboard_set_free(Bitboard *board, bool const *occupied);
+
+void
+bitboard_set(Bitboard *board, Pose pos);
+
+void
+bitboard_unset(Bitboard *board, Pose pos);
+
+bool
+bitboard_test(Bitboard const *board, Pose pos);
+
+int
+bitboard_count(Bitboard const *board);
+
+// grows reach through the cells set in open, a row at a time with shifts,
+// ANDs and ORs, until it stops growing; returns how many cells it covers.
+// Uses AVX2 or SSE2 when the CPU has them unless bitboard_use_step says
+// otherwise.
+int
+bitboard_flood(Bitboard *reach, Bitboard const *open);
+
+// how bitboard_flood steps a row: best is the fastest the CPU has
+enum BITBOARD_STEP
+{
+    BITBOARD_STEP_best,
+    BITBOARD_STEP_scalar,
+    BITBOARD_STEP_sse2,
+    BITBOARD_STEP_avx2,
+};
+
+// makes every flood from now on step rows this way; false, changing
+// nothing, if the CPU cannot
+bool
+bitboard_use_step(enum BITBOARD_STEP step);
+
+// the cells of open reachable from start, start included, left in reach;
+// 0 if start is not open
+int
+bitboard_reachable(Bitboard *reach, Bitboard const *open, Pose start);
+
+#endif // !BITBOARD_H
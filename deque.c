@@ -2,208 +2,184 @@
 #include <stdio.h>
 #include "deque.h"
 
-bool
-pose_equal(Pose a, Pose b)
-{
-    return a.x == b.x && a.y == b.y;
-}
-
-Node *
-node_new(Pose pos)
+static int
+deque_index(Deque const *deq, int i)
 {
-    Node *n = malloc(sizeof *n);
-    n->data = pos;
-    n->next = NULL;
-    n->prev = NULL;
-    return n;
+    int idx = deq->front + i;
+    if (idx >= deq->capacity)
+    {
+        idx -= deq->capacity;
+    }
+    return idx;
 }
 
-void
-node_destroy(Node *n)
+bool
+pose_equal(Pose a, Pose b)
 {
-    free(n);
+    return a.x == b.x && a.y == b.y;
 }
 
 void
-node_print(Node const *n)
+pose_print(Pose pos)
 {
-    printf("(%d, %d)", n->data.x, n->data.y);
+    printf("(%d, %d)", pos.x, pos.y);
 }
 
 Deque *
-deque_new(void)
+deque_new(int capacity)
 {
     Deque *deq = malloc(sizeof *deq);
-    deq->head = malloc(sizeof *deq->head);
-    deq->tail = malloc(sizeof *deq->tail);
-
-    deq->head->next = deq->tail;
-    deq->head->prev = NULL;
-    deq->head->data = (Pose) {-1, -1};
-
-    deq->tail->next = NULL;
-    deq->tail->prev = deq->head;
-    deq->tail->data = (Pose) {-1, -1};
+    if (deq == NULL)
+    {
+        return NULL;
+    }
+    Pose *data = malloc(capacity * sizeof *data);
+    if (data == NULL)
+    {
+        free(deq);
+        return NULL;
+    }
+    deque_init(deq, data, capacity);
+    return deq;
+}
 
+void
+deque_init(Deque *deq, Pose *data, int capacity)
+{
+    deq->data = data;
+    deq->capacity = capacity;
+    deq->front = 0;
     deq->length = 0;
-    return deq;
 }
 
 void
 deque_destroy(Deque *deq)
 {
-    Node *cur = deq->head;
-    while (cur)
-    {
-        Node *next = cur->next;
-        free(cur);
-        cur = next;
-    }
-
+    free(deq->data);
     free(deq);
 }
 
 void
 deque_print(Deque const *deq)
 {
-    Node *cur = deq->head;
     printf("forward:\n");
-    while (cur->next)
+    for (int i = 0; i < deq->length; i++)
     {
-        node_print(cur);
+        pose_print(deque_get(deq, i));
         printf("->");
-        cur = cur->next;
     }
-    node_print(cur);
     printf("\n");
 
     printf("backward:\n");
-    while (cur->prev)
+    for (int i = deq->length - 1; i >= 0; i--)
     {
-        node_print(cur);
+        pose_print(deque_get(deq, i));
         printf("->");
-        cur = cur->prev;
     }
-    node_print(cur);
     printf("%d", deq->length);
     printf("\n");
 }
 
-Node *
-deque_push_front(Deque *deq, Node *n)
-{
-    deq->head->next->prev = n;
-    n->next = deq->head->next;
-    n->prev = deq->head;
-    deq->head->next = n;
-    deq->length++;
-    return n;
-}
-
-Node *
-deque_push_back(Deque *deq, Node *n)
+bool
+deque_push_front(Deque *deq, Pose pos)
 {
-    deq->tail->prev->next = n;
-    n->prev = deq->tail->prev;
-    n->next = deq->tail;
-    deq->tail->prev = n;
+    if (deq->length == deq->capacity)
+    {
+        return false;
+    }
+    deq->front = deq->front == 0 ? deq->capacity - 1 : deq->front - 1;
+    deq->data[deq->front] = pos;
     deq->length++;
-    return n;
+    return true;
 }
 
-Node *
-deque_pop_front_r(Deque *deq)
+bool
+deque_push_back(Deque *deq, Pose pos)
 {
-    Node *to_remove = deq->head->next;
-    if (to_remove == deq->tail)
+    if (deq->length == deq->capacity)
     {
-        return NULL;
+        return false;
     }
-    deq->head->next = to_remove->next;
-    to_remove->next->prev = deq->head;
-
-    to_remove->next = NULL;
-    to_remove->prev = NULL;
-
-    deq->length--;
-
-    return to_remove;
+    deq->data[deque_index(deq, deq->length)] = pos;
+    deq->length++;
+    return true;
 }
 
-void
+Pose
 deque_pop_front(Deque *deq)
 {
-    node_destroy(deque_pop_front_r(deq));
-}
-
-
-Node *
-deque_pop_back_r(Deque *deq)
-{
-    Node *to_remove = deq->tail->prev;
-    if (to_remove == deq->head)
+    if (deq->length == 0)
     {
-        return NULL;
+        return (Pose) {-1, -1};
     }
-    deq->tail->prev = to_remove->prev;
-    to_remove->prev->next = deq->tail;
-
-    to_remove->next = NULL;
-    to_remove->prev = NULL;
-
+    Pose pos = deq->data[deq->front];
+    deq->front = deque_index(deq, 1);
     deq->length--;
-
-    return to_remove;
+    return pos;
 }
 
-void
+Pose
 deque_pop_back(Deque *deq)
 {
-    node_destroy(deque_pop_back_r(deq));
+    if (deq->length == 0)
+    {
+        return (Pose) {-1, -1};
+    }
+    deq->length--;
+    return deq->data[deque_index(deq, deq->length)];
 }
 
 void
 deque_clear(Deque *deq)
 {
-    Node *n = NULL;
-    while ((n = deque_pop_front_r(deq)) != NULL)
-    {
-        node_destroy(n);
-    }
+    deq->front = 0;
     deq->length = 0;
 }
 
 bool
 deque_contains(Deque const *deq, Pose pos)
 {
-    Node *cur = deq->head->next;
-    while (cur != deq->tail)
+    // walk the two contiguous runs of the ring
+    int first = deq->capacity - deq->front;
+    if (first > deq->length)
+    {
+        first = deq->length;
+    }
+    for (int i = 0; i < first; i++)
+    {
+        if (pose_equal(deq->data[deq->front + i], pos))
+        {
+            return true;
+        }
+    }
+    for (int i = 0; i < deq->length - first; i++)
     {
-        if (pose_equal(cur->data, pos))
+        if (pose_equal(deq->data[i], pos))
         {
             return true;
         }
-        cur = cur->next;
     }
     return false;
 }
 
-Node *
-deque_get_head(Deque const *deq)
+Pose
+deque_get(Deque const *deq, int i)
 {
-    if (deq->head->next == deq->tail)
+    if (i < 0 || i >= deq->length)
     {
-        return NULL;
+        return (Pose) {-1, -1};
     }
-    return deq->head->next;
+    return deq->data[deque_index(deq, i)];
 }
 
-Node *
+Pose
+deque_get_head(Deque const *deq)
+{
+    return deque_get(deq, 0);
+}
+
+Pose
 deque_get_tail(Deque const *deq)
 {
-    if (deq->tail->prev == deq->head)
-    {
-        return NULL;
-    }
-    return deq->tail->prev;
+    return deque_get(deq, deq->length - 1);
 }
@@ -9,18 +9,12 @@ typedef struct Pose
 }
 Pose;
 
-typedef struct Node
-{
-    Pose data;
-    struct Node *next;
-    struct Node *prev;
-}
-Node;
-
+// fixed capacity ring buffer, element i lives at data[(front + i) % capacity]
 typedef struct Deque
 {
-    Node *head;
-    Node *tail;
+    Pose *data;
+    int capacity;
+    int front;
     int length;
 }
 Deque;
@@ -28,17 +22,15 @@ Deque;
 bool
 pose_equal(Pose a, Pose b);
 
-Node *
-node_new(Pose pos);
-
 void
-node_destroy(Node *n);
-
-void
-node_print(Node const *n);
+pose_print(Pose pos);
 
 Deque *
-deque_new(void);
+deque_new(int capacity);
+
+// sets up a deque on storage the caller owns, data holding capacity poses
+void
+deque_init(Deque *deq, Pose *data, int capacity);
 
 void
 deque_destroy(Deque *deq);
@@ -46,22 +38,16 @@ deque_destroy(Deque *deq);
 void
 deque_print(Deque const *deq);
 
-Node *
-deque_push_front(Deque *deq, Node *n);
-
-Node *
-deque_push_back(Deque *deq, Node *n);
+bool
+deque_push_front(Deque *deq, Pose pos);
 
-Node *
-deque_pop_front_r(Deque *deq);
+bool
+deque_push_back(Deque *deq, Pose pos);
 
-void
+Pose
 deque_pop_front(Deque *deq);
 
-Node *
-deque_pop_back_r(Deque *deq);
-
-void
+Pose
 deque_pop_back(Deque *deq);
 
 void
@@ -70,9 +56,12 @@ deque_clear(Deque *deq);
 bool
 deque_contains(Deque const *deq, Pose pos);
 
-Node *
+Pose
+deque_get(Deque const *deq, int i);
+
+Pose
 deque_get_head(Deque const *deq);
 
-Node *
+Pose
 deque_get_tail(Deque const *deq);
 #endif // !DEQUE_H
@@ -0,0 +1,128 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include "eventloop.h"
+
+#define NS_PER_SEC 1000000000LL
+
+enum
+{
+    FD_input,
+    FD_tick,
+    FD_resize,
+    FD_count,
+};
+
+struct EventLoop
+{
+    struct pollfd fds[FD_count];
+    int64_t deadline_ns;
+};
+
+EventLoop *
+eventloop_new(int input_fd)
+{
+    EventLoop *ev = malloc(sizeof *ev);
+    if (ev == NULL)
+    {
+        return NULL;
+    }
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGWINCH);
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+
+    int tick_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    int resize_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (tick_fd < 0 || resize_fd < 0)
+    {
+        if (tick_fd >= 0)
+        {
+            close(tick_fd);
+        }
+        if (resize_fd >= 0)
+        {
+            close(resize_fd);
+        }
+        free(ev);
+        return NULL;
+    }
+
+    ev->fds[FD_input] = (struct pollfd) {.fd = input_fd, .events = POLLIN};
+    ev->fds[FD_tick] = (struct pollfd) {.fd = tick_fd, .events = POLLIN};
+    ev->fds[FD_resize] = (struct pollfd) {.fd = resize_fd, .events = POLLIN};
+    ev->deadline_ns = 0;
+
+    return ev;
+}
+
+void
+eventloop_destroy(EventLoop *ev)
+{
+    close(ev->fds[FD_tick].fd);
+    close(ev->fds[FD_resize].fd);
+    free(ev);
+}
+
+void
+eventloop_arm(EventLoop *ev, int64_t deadline_ns)
+{
+    if (deadline_ns == ev->deadline_ns)
+    {
+        return;
+    }
+    ev->deadline_ns = deadline_ns;
+
+    struct itimerspec its = {
+        .it_value = {
+            .tv_sec = deadline_ns / NS_PER_SEC,
+            .tv_nsec = deadline_ns % NS_PER_SEC,
+        },
+    };
+    timerfd_settime(ev->fds[FD_tick].fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+int
+eventloop_wait(EventLoop *ev)
+{
+    int n;
+    while ((n = poll(ev->fds, FD_count, -1)) < 0 && errno == EINTR)
+    {
+    }
+    if (n < 0)
+    {
+        return 0;
+    }
+
+    int events = 0;
+    if (ev->fds[FD_input].revents & (POLLIN | POLLHUP | POLLERR))
+    {
+        events |= EVENT_input;
+    }
+    if (ev->fds[FD_tick].revents & POLLIN)
+    {
+        uint64_t expirations;
+        if (read(ev->fds[FD_tick].fd, &expirations, sizeof expirations) > 0)
+        {
+            events |= EVENT_tick;
+        }
+        // a one shot timer stays disarmed until the next deadline is set
+        ev->deadline_ns = 0;
+    }
+    if (ev->fds[FD_resize].revents & POLLIN)
+    {
+        struct signalfd_siginfo info;
+        while (read(ev->fds[FD_resize].fd, &info, sizeof info) > 0)
+        {
+        }
+        events |= EVENT_resize;
+    }
+    return events;
+}
@@ -0,0 +1,31 @@
+#ifndef EVENTLOOP_H
+#define EVENTLOOP_H
+
+#include <stdint.h>
+
+// stdin, the tick deadline and terminal resizes multiplexed on one poll(2)
+enum EVENT
+{
+    EVENT_input = 1 << 0,
+    EVENT_tick = 1 << 1,
+    EVENT_resize = 1 << 2,
+};
+
+typedef struct EventLoop EventLoop;
+
+// blocks SIGWINCH for the whole process, so create it before any threads
+EventLoop *
+eventloop_new(int input_fd);
+
+void
+eventloop_destroy(EventLoop *ev);
+
+// absolute CLOCK_MONOTONIC deadline for the next EVENT_tick, 0 disarms
+void
+eventloop_arm(EventLoop *ev, int64_t deadline_ns);
+
+// sleeps until at least one event is ready and returns the EVENT bits
+int
+eventloop_wait(EventLoop *ev);
+
+#endif // !EVENTLOOP_H
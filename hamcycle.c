@@ -0,0 +1,287 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "hamcycle.h"
+
+#define HAMCYCLE_MAGIC "SNKH"
+#define HAMCYCLE_BYTE_ORDER 0x01020304
+#define HAMCYCLE_HEADER_SIZE 20
+
+bool
+hamcycle_exists(int nlines, int ncols)
+{
+    return nlines > 1 && ncols > 1 && (nlines % 2 == 0 || ncols % 2 == 0);
+}
+
+// runs down the rows in pairs and back up the first column; a board with an
+// odd number of rows is done the same way on its side
+static void
+hamcycle_fill(int nlines, int ncols, uint32_t *order)
+{
+    bool rows = nlines % 2 == 0;
+    int outer = rows ? nlines : ncols;
+    int inner = rows ? ncols : nlines;
+    uint32_t next = 0;
+
+    for (int a = 0; a < outer; a++)
+    {
+        for (int i = 0; i < inner - 1; i++)
+        {
+            int b = a % 2 == 0 ? i + 1 : inner - 1 - i;
+            int cell = rows ? a * ncols + b : b * ncols + a;
+            order[cell] = next++;
+        }
+    }
+    for (int a = outer - 1; a >= 0; a--)
+    {
+        order[rows ? a * ncols : a] = next++;
+    }
+}
+
+bool
+hamcycle_valid(int nlines, int ncols, uint32_t const *order)
+{
+    int ncells = nlines * ncols;
+    // the cell at each place along the cycle
+    int *cells = malloc(ncells * sizeof *cells);
+    if (cells == NULL)
+    {
+        return false;
+    }
+    for (int i = 0; i < ncells; i++)
+    {
+        cells[i] = -1;
+    }
+
+    bool valid = true;
+    for (int cell = 0; cell < ncells && valid; cell++)
+    {
+        valid = order[cell] < (uint32_t) ncells && cells[order[cell]] < 0;
+        if (valid)
+        {
+            cells[order[cell]] = cell;
+        }
+    }
+    for (int i = 0; i < ncells && valid; i++)
+    {
+        int a = cells[i];
+        int b = cells[(i + 1) % ncells];
+        int dy = abs(a / ncols - b / ncols);
+        int dx = abs(a % ncols - b % ncols);
+        valid = dy + dx == 1;
+    }
+    free(cells);
+    return valid;
+}
+
+HamCycle *
+hamcycle_build(int nlines, int ncols)
+{
+    if (hamcycle_exists(nlines, ncols) == false)
+    {
+        return NULL;
+    }
+    HamCycle *cycle = malloc(sizeof *cycle);
+    uint32_t *order = malloc((size_t) nlines * ncols * sizeof *order);
+    if (cycle == NULL || order == NULL)
+    {
+        free(cycle);
+        free(order);
+        return NULL;
+    }
+    hamcycle_fill(nlines, ncols, order);
+    if (hamcycle_valid(nlines, ncols, order) == false)
+    {
+        free(cycle);
+        free(order);
+        return NULL;
+    }
+    *cycle = (HamCycle) {
+        .nlines = nlines,
+        .ncols = ncols,
+        .order = order,
+        .mapping = NULL,
+        .mapping_size = 0,
+    };
+    return cycle;
+}
+
+static void
+hamcycle_path(char *buf, size_t size, const char *dir, int nlines, int ncols)
+{
+    snprintf(buf, size, "%s/cycle-%dx%d", dir, nlines, ncols);
+}
+
+// NULL if the file is missing or is not a cycle for this board
+static HamCycle *
+hamcycle_map(const char *path, int nlines, int ncols)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    size_t size =
+        HAMCYCLE_HEADER_SIZE + (size_t) nlines * ncols * sizeof(uint32_t);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size != size)
+    {
+        close(fd);
+        return NULL;
+    }
+    void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    uint8_t const *p = data;
+    uint32_t header[3];
+    memcpy(header, p + 8, sizeof header);
+    HamCycle *cycle = malloc(sizeof *cycle);
+    if (cycle == NULL || memcmp(p, HAMCYCLE_MAGIC, 4) != 0 ||
+        p[4] != HAMCYCLE_VERSION || header[0] != HAMCYCLE_BYTE_ORDER ||
+        header[1] != (uint32_t) nlines || header[2] != (uint32_t) ncols)
+    {
+        free(cycle);
+        munmap(data, size);
+        return NULL;
+    }
+    *cycle = (HamCycle) {
+        .nlines = nlines,
+        .ncols = ncols,
+        .order = (uint32_t const *) (p + HAMCYCLE_HEADER_SIZE),
+        .mapping = data,
+        .mapping_size = size,
+    };
+    return cycle;
+}
+
+// mkdir -p
+static bool
+hamcycle_make_dirs(const char *dir)
+{
+    char path[PATH_MAX];
+    if (snprintf(path, sizeof path, "%s", dir) >= (int) sizeof path)
+    {
+        return false;
+    }
+    for (char *p = path + 1; *p != '\0'; p++)
+    {
+        if (*p == '/')
+        {
+            *p = '\0';
+            if (mkdir(path, 0755) != 0 && errno != EEXIST)
+            {
+                return false;
+            }
+            *p = '/';
+        }
+    }
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+// written under a temporary name and renamed into place, so a reader never
+// maps half a file however many processes race to fill the cache
+static bool
+hamcycle_store(HamCycle const *cycle, const char *dir, const char *path)
+{
+    char tmp[PATH_MAX];
+    if (hamcycle_make_dirs(dir) == false ||
+        snprintf(tmp, sizeof tmp, "%s.XXXXXX", path) >= (int) sizeof tmp)
+    {
+        return false;
+    }
+    int fd = mkstemp(tmp);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    uint8_t header[HAMCYCLE_HEADER_SIZE] = {0};
+    uint32_t fields[3] = {HAMCYCLE_BYTE_ORDER, cycle->nlines, cycle->ncols};
+    memcpy(header, HAMCYCLE_MAGIC, 4);
+    header[4] = HAMCYCLE_VERSION;
+    memcpy(header + 8, fields, sizeof fields);
+    size_t size = (size_t) cycle->nlines * cycle->ncols * sizeof(uint32_t);
+    bool ok = write(fd, header, sizeof header) == sizeof header &&
+              write(fd, cycle->order, size) == (ssize_t) size;
+    ok = close(fd) == 0 && ok;
+    if (ok == false || rename(tmp, path) != 0)
+    {
+        unlink(tmp);
+        return false;
+    }
+    return true;
+}
+
+HamCycle *
+hamcycle_open(int nlines, int ncols, const char *cache_dir)
+{
+    if (hamcycle_exists(nlines, ncols) == false)
+    {
+        return NULL;
+    }
+    if (cache_dir == NULL)
+    {
+        return hamcycle_build(nlines, ncols);
+    }
+    char path[PATH_MAX];
+    hamcycle_path(path, sizeof path, cache_dir, nlines, ncols);
+    HamCycle *cycle = hamcycle_map(path, nlines, ncols);
+    if (cycle != NULL)
+    {
+        return cycle;
+    }
+
+    cycle = hamcycle_build(nlines, ncols);
+    if (cycle != NULL)
+    {
+        hamcycle_store(cycle, cache_dir, path);
+    }
+    return cycle;
+}
+
+void
+hamcycle_close(HamCycle *cycle)
+{
+    if (cycle->mapping != NULL)
+    {
+        munmap(cycle->mapping, cycle->mapping_size);
+    }
+    else
+    {
+        free((void *) cycle->order);
+    }
+    free(cycle);
+}
+
+const char *
+hamcycle_default_dir(char *buf, size_t size)
+{
+    const char *xdg = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    int n;
+    if (xdg != NULL && xdg[0] != '\0')
+    {
+        n = snprintf(buf, size, "%s/snake", xdg);
+    }
+    else if (home != NULL && home[0] != '\0')
+    {
+        n = snprintf(buf, size, "%s/.cache/snake", home);
+    }
+    else
+    {
+        return NULL;
+    }
+    return n >= 0 && (size_t) n < size ? buf : NULL;
+}
@@ -0,0 +1,58 @@
+#ifndef HAMCYCLE_H
+#define HAMCYCLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// A Hamiltonian cycle over the board: a closed path through every cell once.
+// One exists when nlines * ncols is even and both are above one. Cycles are
+// cached per board size in the directory given to hamcycle_open, one file
+// each (all in host byte order, the cache is local to a machine):
+//   "SNKH" u8 version, 3 reserved bytes, u32 0x01020304, u32 nlines,
+//   u32 ncols, then u32 order per cell, row major
+// and later opens map the file instead of building and checking again.
+
+#define HAMCYCLE_VERSION 1
+// room for any directory hamcycle_default_dir gives
+#define HAMCYCLE_DIR_MAX 4096
+
+typedef struct HamCycle
+{
+    int nlines;
+    int ncols;
+    // each cell's place along the cycle, row major
+    uint32_t const *order;
+    // the mapped file, or NULL when order was built on the heap
+    void *mapping;
+    size_t mapping_size;
+}
+HamCycle;
+
+bool
+hamcycle_exists(int nlines, int ncols);
+
+// builds and checks a cycle without touching the cache; NULL if the board
+// has none or it could not be allocated
+HamCycle *
+hamcycle_build(int nlines, int ncols);
+
+// true if order visits every cell once, each step to a neighbor, and
+// comes back to where it started
+bool
+hamcycle_valid(int nlines, int ncols, uint32_t const *order);
+
+// maps the cached cycle for the board, or builds it and caches it; a
+// NULL or unusable cache_dir only costs the build. NULL as hamcycle_build
+HamCycle *
+hamcycle_open(int nlines, int ncols, const char *cache_dir);
+
+void
+hamcycle_close(HamCycle *cycle);
+
+// $XDG_CACHE_HOME/snake or ~/.cache/snake, written to buf; NULL if neither
+// variable is set or buf is too small
+const char *
+hamcycle_default_dir(char *buf, size_t size);
+
+#endif // !HAMCYCLE_H
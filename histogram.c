@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <string.h>
+#include "histogram.h"
+
+#define SUB_COUNT (1 << HISTOGRAM_SUB_BITS)
+
+static int
+histogram_bucket(int64_t value)
+{
+    if (value < SUB_COUNT)
+    {
+        return value < 0 ? 0 : value;
+    }
+    if (value >> HISTOGRAM_MAX_BITS != 0)
+    {
+        return HISTOGRAM_BUCKETS - 1;
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - HISTOGRAM_SUB_BITS;
+    return ((shift + 1) << HISTOGRAM_SUB_BITS) |
+           ((value >> shift) & (SUB_COUNT - 1));
+}
+
+// the largest value that lands in bucket
+static int64_t
+histogram_bucket_high(int bucket)
+{
+    if (bucket < SUB_COUNT)
+    {
+        return bucket;
+    }
+    int shift = (bucket >> HISTOGRAM_SUB_BITS) - 1;
+    int64_t low = (int64_t) (SUB_COUNT | (bucket & (SUB_COUNT - 1))) << shift;
+    return low + ((int64_t) 1 << shift) - 1;
+}
+
+void
+histogram_reset(Histogram *hist)
+{
+    memset(hist, 0, sizeof *hist);
+}
+
+void
+histogram_record(Histogram *hist, int64_t value)
+{
+    hist->counts[histogram_bucket(value)]++;
+    hist->total++;
+    if (value > hist->max)
+    {
+        hist->max = value;
+    }
+}
+
+int64_t
+histogram_percentile(Histogram const *hist, double p)
+{
+    if (hist->total == 0)
+    {
+        return 0;
+    }
+    // the rank of the sample at p, counting from 1
+    uint64_t rank = p / 100 * hist->total + 0.5;
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        seen += hist->counts[i];
+        // the last bucket also holds everything past the range
+        if (seen >= rank && i < HISTOGRAM_BUCKETS - 1)
+        {
+            int64_t high = histogram_bucket_high(i);
+            return high < hist->max ? high : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+void
+histogram_format_ns(char *buf, size_t size, int64_t ns)
+{
+    if (ns < 1000)
+    {
+        snprintf(buf, size, "%lldns", (long long) ns);
+    }
+    else if (ns < 1000000)
+    {
+        snprintf(buf, size, "%.1fus", ns / 1e3);
+    }
+    else if (ns < 1000000000)
+    {
+        snprintf(buf, size, "%.1fms", ns / 1e6);
+    }
+    else
+    {
+        snprintf(buf, size, "%.2fs", ns / 1e9);
+    }
+}
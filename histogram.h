@@ -0,0 +1,40 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// log-linear buckets in the style of HdrHistogram: each power of two is
+// split into 2^HISTOGRAM_SUB_BITS buckets, so any recorded value is known
+// to within about 3%, from 1 ns up to 2^HISTOGRAM_MAX_BITS ns (~18 minutes)
+#define HISTOGRAM_SUB_BITS 5
+#define HISTOGRAM_MAX_BITS 40
+#define HISTOGRAM_BUCKETS \
+    ((HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS)
+
+// fixed size and allocation free, so it can be embedded anywhere
+typedef struct Histogram
+{
+    uint64_t counts[HISTOGRAM_BUCKETS];
+    uint64_t total;
+    int64_t max;
+}
+Histogram;
+
+void
+histogram_reset(Histogram *hist);
+
+// negative values count as 0, values past the range as the largest bucket
+void
+histogram_record(Histogram *hist, int64_t value);
+
+// the highest value equivalent to the p-th percentile, 0 <= p <= 100;
+// 0 when nothing was recorded
+int64_t
+histogram_percentile(Histogram const *hist, double p);
+
+// a duration in ns, us, ms or s, fitting any in 7 columns
+void
+histogram_format_ns(char *buf, size_t size, int64_t ns);
+
+#endif // !HISTOGRAM_H
@@ -0,0 +1,700 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "mcts.h"
+#include "timer.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// nodes one thread's tree may grow to; past it the search only rolls out
+#define MCTS_NODES 65536
+// moves a path down the tree may take before it rolls out regardless
+#define MCTS_MAX_DEPTH 256
+// moves a rollout plays below the tree before the board is scored; longer
+// ones mostly die to random moves and drown out the difference between
+// the first few
+#define MCTS_ROLLOUT_STEPS 16
+// tries at a random cell before food is placed by a scan
+#define MCTS_FOOD_TRIES 32
+#define MCTS_DEFAULT_BUDGET_NS 1000000
+// how much less a meal a move later is worth
+#define MCTS_MEAL_DISCOUNT 0.9
+// UCB1's exploration weight
+#define MCTS_EXPLORE 1.4
+
+// A game cut down to what a rollout needs and laid out flat, so a copy is
+// a memcpy: this header, then the body as a ring of ncells cell indices,
+// head at front, then one bit per cell set under the body. Food lands from
+// the copy's own rng, not the game's, so rollouts cannot foresee it.
+typedef struct Sim {
+    int ncols;
+    int nlines;
+    int ncells;
+    int front;
+    int length;
+    enum DIRECTION dir;
+    int food;
+    enum STATE state;
+    // moves made since the copy, and how many it took to first eat, or -1
+    int steps;
+    int first_meal;
+    Rng rng;
+} Sim;
+
+static size_t sim_size(int ncells) {
+    return sizeof(Sim) + ncells * sizeof(int) + (ncells + 7) / 8;
+}
+
+static int *sim_ring(Sim *sim) {
+    return (int *)(sim + 1);
+}
+
+static uint8_t *sim_bits(Sim *sim) {
+    return (uint8_t *)(sim_ring(sim) + sim->ncells);
+}
+
+static bool sim_taken(Sim *sim, int cell) {
+    return sim_bits(sim)[cell >> 3] >> (cell & 7) & 1;
+}
+
+static void sim_set(Sim *sim, int cell, bool taken) {
+    uint8_t bit = 1 << (cell & 7);
+    if (taken) {
+        sim_bits(sim)[cell >> 3] |= bit;
+    } else {
+        sim_bits(sim)[cell >> 3] &= ~bit;
+    }
+}
+
+// only the live part of the ring is copied, it stays where it was
+static void sim_copy(Sim *dst, Sim *src) {
+    int *ring = sim_ring(src);
+    int first = src->ncells - src->front;
+    first = first < src->length ? first : src->length;
+    memcpy(dst, src, sizeof *src);
+    memcpy(sim_ring(dst) + src->front, ring + src->front,
+           first * sizeof *ring);
+    memcpy(sim_ring(dst), ring, (src->length - first) * sizeof *ring);
+    memcpy(sim_bits(dst), sim_bits(src), (src->ncells + 7) / 8);
+}
+
+static void sim_load(Sim *sim, Snake const *snake) {
+    Deque const *deq = snake->deq;
+    sim->ncols = snake->ncols;
+    sim->nlines = snake->nlines;
+    sim->ncells = snake->nlines * snake->ncols;
+    sim->front = 0;
+    sim->length = deq->length;
+    sim->dir = snake->dir;
+    sim->food = snake->food_pos.y * snake->ncols + snake->food_pos.x;
+    // a game waiting for its first move is played as if it had begun
+    sim->state = snake->state == STATE_null ? STATE_active : snake->state;
+    sim->steps = 0;
+    sim->first_meal = -1;
+    memset(sim_bits(sim), 0, (sim->ncells + 7) / 8);
+    for (int i = 0; i < deq->length; i++) {
+        Pose pos =
+            deque_get(deq, snake->flipped ? deq->length - 1 - i : i);
+        int cell = pos.y * sim->ncols + pos.x;
+        sim_ring(sim)[i] = cell;
+        sim_set(sim, cell, true);
+    }
+}
+
+static bool sim_reverses(enum DIRECTION from, enum DIRECTION to) {
+    return (from == DIRECTION_left && to == DIRECTION_right) ||
+           (from == DIRECTION_right && to == DIRECTION_left) ||
+           (from == DIRECTION_up && to == DIRECTION_down) ||
+           (from == DIRECTION_down && to == DIRECTION_up);
+}
+
+// the cell one move from the head, -1 off the board
+static int sim_next(Sim *sim, enum DIRECTION dir) {
+    int head = sim_ring(sim)[sim->front];
+    int y = head / sim->ncols;
+    int x = head % sim->ncols;
+    switch (dir) {
+    case DIRECTION_left:
+        return x > 0 ? head - 1 : -1;
+    case DIRECTION_right:
+        return x < sim->ncols - 1 ? head + 1 : -1;
+    case DIRECTION_up:
+        return y > 0 ? head - sim->ncols : -1;
+    case DIRECTION_down:
+        return y < sim->nlines - 1 ? head + sim->ncols : -1;
+    default:
+        return -1;
+    }
+}
+
+static void sim_place_food(Sim *sim) {
+    for (int i = 0; i < MCTS_FOOD_TRIES; i++) {
+        int cell = rng_below(&sim->rng, sim->ncells);
+        if (sim_taken(sim, cell) == false) {
+            sim->food = cell;
+            return;
+        }
+    }
+    int start = rng_below(&sim->rng, sim->ncells);
+    for (int i = 0; i < sim->ncells; i++) {
+        int cell = (start + i) % sim->ncells;
+        if (sim_taken(sim, cell) == false) {
+            sim->food = cell;
+            return;
+        }
+    }
+}
+
+// one tick as snake_update plays it, a reversal keeping the old heading
+static void sim_step(Sim *sim, enum DIRECTION dir) {
+    sim->steps++;
+    if (sim_reverses(sim->dir, dir) == false) {
+        sim->dir = dir;
+    }
+    int next = sim_next(sim, sim->dir);
+    int *ring = sim_ring(sim);
+    if (next < 0 || sim_taken(sim, next)) {
+        sim->state = STATE_lose;
+        return;
+    }
+    if (next != sim->food) {
+        int tail = (sim->front + sim->length - 1) % sim->ncells;
+        sim_set(sim, ring[tail], false);
+        sim->length--;
+    }
+    sim->front = sim->front == 0 ? sim->ncells - 1 : sim->front - 1;
+    ring[sim->front] = next;
+    sim->length++;
+    sim_set(sim, next, true);
+    if (next == sim->food) {
+        if (sim->first_meal < 0) {
+            sim->first_meal = sim->steps;
+        }
+        if (sim->length == sim->ncells) {
+            sim->state = STATE_win;
+            return;
+        }
+        sim_place_food(sim);
+    }
+}
+
+static const enum DIRECTION directions[4] = {
+    DIRECTION_left,
+    DIRECTION_right,
+    DIRECTION_up,
+    DIRECTION_down,
+};
+
+// a move that is not a reversal and does not hit anything at once
+static bool sim_safe(Sim *sim, enum DIRECTION dir) {
+    if (sim_reverses(sim->dir, dir)) {
+        return false;
+    }
+    int next = sim_next(sim, dir);
+    return next >= 0 && sim_taken(sim, next) == false;
+}
+
+static int sim_food_dist(Sim *sim, int cell) {
+    return abs(cell / sim->ncols - sim->food / sim->ncols) +
+           abs(cell % sim->ncols - sim->food % sim->ncols);
+}
+
+// a move that does not hit anything at once, mostly one closing on the food:
+// uniformly random playouts rarely find it on a big board
+static enum DIRECTION sim_rollout_move(Sim *sim, Rng *rng) {
+    enum DIRECTION safe[4];
+    enum DIRECTION closer[4];
+    int nsafe = 0;
+    int ncloser = 0;
+    int dist = sim_food_dist(sim, sim_ring(sim)[sim->front]);
+    for (int i = 0; i < 4; i++) {
+        if (sim_safe(sim, directions[i])) {
+            safe[nsafe++] = directions[i];
+            if (sim_food_dist(sim, sim_next(sim, directions[i])) < dist) {
+                closer[ncloser++] = directions[i];
+            }
+        }
+    }
+    if (ncloser > 0 && rng_below(rng, 4) != 0) {
+        return closer[rng_below(rng, ncloser)];
+    }
+    return nsafe == 0 ? sim->dir : safe[rng_below(rng, nsafe)];
+}
+
+// a flood's scratch, one per worker: stamps mark the cells seen by the
+// flood numbered stamp
+typedef struct Flood {
+    int *queue;
+    uint32_t *seen;
+    uint32_t stamp;
+} Flood;
+
+// true if the head has a way to where the tail is now, or room for as many
+// moves as the body is long, by when the body has moved out of the way;
+// either way the snake is not yet walled in
+static bool sim_tail_reachable(Sim *sim, Flood *flood) {
+    int *ring = sim_ring(sim);
+    int head = ring[sim->front];
+    int tail = ring[(sim->front + sim->length - 1) % sim->ncells];
+    if (++flood->stamp == 0) {
+        memset(flood->seen, 0, sim->ncells * sizeof *flood->seen);
+        flood->stamp = 1;
+    }
+    int count = 0;
+    int next = 0;
+    flood->queue[count++] = head;
+    flood->seen[head] = flood->stamp;
+    while (next < count && count <= sim->length) {
+        int cell = flood->queue[next++];
+        int y = cell / sim->ncols;
+        int x = cell % sim->ncols;
+        int around[4] = {
+            x > 0 ? cell - 1 : -1,
+            x < sim->ncols - 1 ? cell + 1 : -1,
+            y > 0 ? cell - sim->ncols : -1,
+            y < sim->nlines - 1 ? cell + sim->ncols : -1,
+        };
+        for (int i = 0; i < 4; i++) {
+            int at = around[i];
+            if (at == tail && cell != head) {
+                return true;
+            }
+            if (at < 0 || flood->seen[at] == flood->stamp ||
+                sim_taken(sim, at)) {
+                continue;
+            }
+            flood->seen[at] = flood->stamp;
+            flood->queue[count++] = at;
+        }
+    }
+    return count > sim->length;
+}
+
+// 0 for a loss, 1 for a win; a survivor that ate gets half and up to the
+// other half the sooner it did, one that did not gets less the farther it
+// ended from the food. A survivor cut off from its tail is all but lost
+// and keeps a tenth of that.
+static double sim_score(Sim *sim, Flood *flood) {
+    if (sim->state == STATE_lose) {
+        return 0;
+    }
+    if (sim->state == STATE_win) {
+        return 1;
+    }
+    double scale = sim_tail_reachable(sim, flood) ? 1 : 0.1;
+    if (sim->first_meal >= 0) {
+        return scale *
+               (0.5 + 0.5 * pow(MCTS_MEAL_DISCOUNT, sim->first_meal));
+    }
+    int dist = sim_food_dist(sim, sim_ring(sim)[sim->front]);
+    return scale * 0.4 * (1 - (double)dist / (sim->nlines + sim->ncols));
+}
+
+typedef struct Node {
+    // by direction - 1, -1 until expanded
+    int child[4];
+    uint32_t visits;
+    double value;
+} Node;
+
+typedef struct Mcts Mcts;
+
+// one tree and the scratch to grow it: every search's own, and each of
+// the pool's helpers, which work on whichever search claimed them
+typedef struct Worker {
+    // the search this worker is part of, NULL for an idle helper
+    Mcts *mcts;
+    pthread_t thread;
+    Rng rng;
+    Node *nodes;
+    int nnodes;
+    // cells sim and flood have room for
+    int ncells;
+    // the game each iteration plays out
+    Sim *sim;
+    Flood flood;
+    long rollouts;
+    // bumped for each search a helper is given
+    uint64_t job;
+} Worker;
+
+struct Mcts {
+    int ncells;
+    int64_t budget_ns;
+    // the position being searched, copied into every iteration
+    Sim *root;
+    // the thread calling choose searches with this one
+    Worker self;
+    // the pool's helpers this search claimed, room for all of them
+    Worker **helpers;
+    int nhelpers;
+    int64_t deadline_ns;
+    // claimed helpers still searching, and its signal when none are
+    int busy;
+    pthread_cond_t done;
+    long rollouts;
+};
+
+// Helper threads every search in the process shares, one fewer than the
+// online CPUs. A search only claims helpers while fewer searches than
+// CPUs are running, so games played side by side, each on its own
+// thread, never search on more threads than there are CPUs.
+typedef struct Pool {
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    // searches alive, the helpers end with the last
+    int users;
+    Worker *helpers;
+    int ncpus;
+    // helper threads started
+    int nthreads;
+    // choose calls under way, the callers' threads busy with them
+    int searching;
+    bool quit;
+} Pool;
+
+static Pool pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work = PTHREAD_COND_INITIALIZER,
+};
+// serializes starting and stopping the pool's threads
+static pthread_mutex_t pool_life = PTHREAD_MUTEX_INITIALIZER;
+
+static int worker_new_node(Worker *worker) {
+    if (worker->nnodes == MCTS_NODES) {
+        return -1;
+    }
+    Node *node = &worker->nodes[worker->nnodes];
+    for (int i = 0; i < 4; i++) {
+        node->child[i] = -1;
+    }
+    node->visits = 0;
+    node->value = 0;
+    return worker->nnodes++;
+}
+
+// room for a board of ncells, kept when it is already big enough
+static bool worker_fit(Worker *worker, int ncells) {
+    if (worker->nodes == NULL) {
+        worker->nodes = malloc(MCTS_NODES * sizeof *worker->nodes);
+    }
+    if (worker->nodes != NULL && worker->ncells >= ncells) {
+        return true;
+    }
+    free(worker->sim);
+    free(worker->flood.queue);
+    free(worker->flood.seen);
+    worker->sim = malloc(sim_size(ncells));
+    worker->flood.queue = malloc(ncells * sizeof *worker->flood.queue);
+    worker->flood.seen = calloc(ncells, sizeof *worker->flood.seen);
+    worker->flood.stamp = 0;
+    worker->ncells = ncells;
+    if (worker->nodes == NULL || worker->sim == NULL ||
+        worker->flood.queue == NULL || worker->flood.seen == NULL) {
+        worker->ncells = 0;
+        return false;
+    }
+    return true;
+}
+
+static void worker_free(Worker *worker) {
+    free(worker->nodes);
+    free(worker->sim);
+    free(worker->flood.queue);
+    free(worker->flood.seen);
+}
+
+// UCB1 over the expanded children, or the first unexpanded one; moves that
+// die at once are left out, -1 when that is all of them
+static int worker_select(Worker *worker, Node *node, Sim *sim) {
+    int best = -1;
+    double best_ucb = -1;
+    double log_visits = log(node->visits + 1);
+    for (int i = 0; i < 4; i++) {
+        if (sim_safe(sim, directions[i]) == false) {
+            continue;
+        }
+        if (node->child[i] < 0) {
+            return i;
+        }
+        Node *child = &worker->nodes[node->child[i]];
+        double ucb = child->value / child->visits +
+                     MCTS_EXPLORE * sqrt(log_visits / child->visits);
+        if (ucb > best_ucb) {
+            best = i;
+            best_ucb = ucb;
+        }
+    }
+    return best;
+}
+
+// down the tree, one node added, a rollout and its score back up the path
+static void worker_iterate(Worker *worker) {
+    Mcts *mcts = worker->mcts;
+    Sim *sim = worker->sim;
+    int path[MCTS_MAX_DEPTH + 1];
+    int depth = 0;
+
+    sim_copy(sim, mcts->root);
+    rng_seed(&sim->rng, rng_next(&worker->rng));
+    path[depth++] = 0;
+    while (sim->state == STATE_active) {
+        Node *node = &worker->nodes[path[depth - 1]];
+        int i = worker_select(worker, node, sim);
+        if (i < 0) {
+            sim_step(sim, sim->dir);
+            break;
+        }
+        bool leaf = node->child[i] < 0;
+        if (leaf) {
+            node->child[i] = worker_new_node(worker);
+        }
+        sim_step(sim, directions[i]);
+        if (node->child[i] < 0) {
+            break;
+        }
+        path[depth++] = node->child[i];
+        if (leaf || depth > MCTS_MAX_DEPTH) {
+            break;
+        }
+    }
+    for (int i = 0; i < MCTS_ROLLOUT_STEPS && sim->state == STATE_active;
+         i++) {
+        sim_step(sim, sim_rollout_move(sim, &worker->rng));
+    }
+    double score = sim_score(sim, &worker->flood);
+    for (int i = 0; i < depth; i++) {
+        worker->nodes[path[i]].visits++;
+        worker->nodes[path[i]].value += score;
+    }
+    worker->rollouts++;
+}
+
+// at least one iteration, so a search always has something to go on
+static void worker_search(Worker *worker) {
+    worker->nnodes = 0;
+    worker->rollouts = 0;
+    worker_new_node(worker);
+    do {
+        worker_iterate(worker);
+    } while (timer_now_ns() < worker->mcts->deadline_ns);
+}
+
+static void *helper_run(void *arg) {
+    Worker *worker = arg;
+    uint64_t job = 0;
+    pthread_mutex_lock(&pool.lock);
+    while (true) {
+        while (worker->job == job && pool.quit == false) {
+            pthread_cond_wait(&pool.work, &pool.lock);
+        }
+        if (pool.quit) {
+            break;
+        }
+        job = worker->job;
+        pthread_mutex_unlock(&pool.lock);
+
+        worker_search(worker);
+
+        pthread_mutex_lock(&pool.lock);
+        if (--worker->mcts->busy == 0) {
+            pthread_cond_signal(&worker->mcts->done);
+        }
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+static void pool_stop(void) {
+    pthread_mutex_lock(&pool.lock);
+    pool.quit = true;
+    pthread_cond_broadcast(&pool.work);
+    pthread_mutex_unlock(&pool.lock);
+    for (int i = 0; i < pool.nthreads; i++) {
+        pthread_join(pool.helpers[i].thread, NULL);
+    }
+    for (int i = 0; i < pool.ncpus - 1 && pool.helpers != NULL; i++) {
+        worker_free(&pool.helpers[i]);
+    }
+    free(pool.helpers);
+    pool.helpers = NULL;
+    pool.nthreads = 0;
+    pool.quit = false;
+}
+
+// the first search starts the helpers, without them every search still
+// runs on its caller's thread
+static void pool_join(void) {
+    pthread_mutex_lock(&pool_life);
+    if (pool.users++ == 0) {
+        long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+        pool.ncpus = ncpus > 0 ? ncpus : 1;
+        pool.helpers = calloc(pool.ncpus - 1, sizeof *pool.helpers);
+        for (int i = 0; i < pool.ncpus - 1 && pool.helpers != NULL; i++) {
+            if (pthread_create(&pool.helpers[i].thread, NULL, helper_run,
+                               &pool.helpers[i]) != 0) {
+                break;
+            }
+            pool.nthreads = i + 1;
+        }
+    }
+    pthread_mutex_unlock(&pool_life);
+}
+
+static void pool_leave(void) {
+    pthread_mutex_lock(&pool_life);
+    if (--pool.users == 0) {
+        pool_stop();
+    }
+    pthread_mutex_unlock(&pool_life);
+}
+
+static void mcts_destroy(void *state);
+
+static void *mcts_create(int nlines, int ncols, uint64_t seed) {
+    Mcts *mcts = calloc(1, sizeof *mcts);
+    if (mcts == NULL) {
+        return NULL;
+    }
+    pool_join();
+    mcts->ncells = nlines * ncols;
+    mcts->budget_ns = MCTS_DEFAULT_BUDGET_NS;
+    mcts->self.mcts = mcts;
+    rng_seed(&mcts->self.rng, seed);
+    mcts->root = malloc(sim_size(mcts->ncells));
+    mcts->helpers = calloc(pool.ncpus, sizeof *mcts->helpers);
+    pthread_cond_init(&mcts->done, NULL);
+    if (mcts->root == NULL || mcts->helpers == NULL ||
+        worker_fit(&mcts->self, mcts->ncells) == false) {
+        mcts_destroy(mcts);
+        return NULL;
+    }
+    return mcts;
+}
+
+static void mcts_destroy(void *state) {
+    Mcts *mcts = state;
+    worker_free(&mcts->self);
+    pthread_cond_destroy(&mcts->done);
+    free(mcts->helpers);
+    free(mcts->root);
+    free(mcts);
+    pool_leave();
+}
+
+static void mcts_reset(void *state, uint64_t seed) {
+    Mcts *mcts = state;
+    rng_seed(&mcts->self.rng, seed);
+}
+
+static void mcts_set_budget(void *state, int64_t budget_ns) {
+    Mcts *mcts = state;
+    mcts->budget_ns = budget_ns;
+}
+
+// takes idle helpers while the searches under way, this one included,
+// leave CPUs free; each is seeded from this search's rng so the helper
+// that happens to be picked does not matter
+static void mcts_claim_helpers(Mcts *mcts) {
+    pthread_mutex_lock(&pool.lock);
+    pool.searching++;
+    mcts->nhelpers = 0;
+    int spare = pool.ncpus - pool.searching;
+    for (int i = 0; i < pool.nthreads && mcts->nhelpers < spare; i++) {
+        Worker *helper = &pool.helpers[i];
+        if (helper->mcts != NULL || worker_fit(helper, mcts->ncells) == false) {
+            continue;
+        }
+        helper->mcts = mcts;
+        rng_seed(&helper->rng, rng_next(&mcts->self.rng));
+        helper->job++;
+        mcts->helpers[mcts->nhelpers++] = helper;
+    }
+    mcts->busy = mcts->nhelpers;
+    if (mcts->nhelpers > 0) {
+        pthread_cond_broadcast(&pool.work);
+    }
+    pthread_mutex_unlock(&pool.lock);
+}
+
+// waits out the helpers, then hands them back once their trees are read
+static void mcts_wait_helpers(Mcts *mcts) {
+    pthread_mutex_lock(&pool.lock);
+    while (mcts->busy > 0) {
+        pthread_cond_wait(&mcts->done, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+}
+
+static void mcts_release_helpers(Mcts *mcts) {
+    pthread_mutex_lock(&pool.lock);
+    for (int i = 0; i < mcts->nhelpers; i++) {
+        mcts->helpers[i]->mcts = NULL;
+    }
+    pool.searching--;
+    pthread_mutex_unlock(&pool.lock);
+}
+
+// adds a tree's visits and values under each first move
+static void mcts_tally(Mcts *mcts, Worker const *worker, uint64_t *visits,
+                       double *value) {
+    mcts->rollouts += worker->rollouts;
+    for (int i = 0; i < 4; i++) {
+        int child = worker->nodes[0].child[i];
+        if (child >= 0) {
+            visits[i] += worker->nodes[child].visits;
+            value[i] += worker->nodes[child].value;
+        }
+    }
+}
+
+// the move with the most visits over all trees
+static enum DIRECTION mcts_choose(void *state, Snake const *snake) {
+    Mcts *mcts = state;
+    sim_load(mcts->root, snake);
+    mcts->deadline_ns = timer_now_ns() + mcts->budget_ns;
+
+    mcts_claim_helpers(mcts);
+    worker_search(&mcts->self);
+    mcts_wait_helpers(mcts);
+
+    uint64_t visits[4] = {0};
+    double value[4] = {0};
+    mcts->rollouts = 0;
+    mcts_tally(mcts, &mcts->self, visits, value);
+    for (int i = 0; i < mcts->nhelpers; i++) {
+        mcts_tally(mcts, mcts->helpers[i], visits, value);
+    }
+    mcts_release_helpers(mcts);
+
+    enum DIRECTION best = snake->dir == DIRECTION_null ? DIRECTION_up
+                                                       : snake->dir;
+    uint64_t best_visits = 0;
+    double best_mean = 0;
+    for (int i = 0; i < 4; i++) {
+        double mean = visits[i] > 0 ? value[i] / visits[i] : 0;
+        if (visits[i] > best_visits ||
+            (visits[i] == best_visits && visits[i] > 0 && mean > best_mean)) {
+            best = directions[i];
+            best_visits = visits[i];
+            best_mean = mean;
+        }
+    }
+    return best;
+}
+
+long mcts_rollouts(void const *state) {
+    Mcts const *mcts = state;
+    return mcts->rollouts;
+}
+
+const Policy mcts_policy = {
+    .name = "mcts",
+    .create = mcts_create,
+    .destroy = mcts_destroy,
+    .reset = mcts_reset,
+    .choose = mcts_choose,
+    .set_budget = mcts_set_budget,
+};
@@ -0,0 +1,17 @@
+#ifndef MCTS_H
+#define MCTS_H
+
+#include "policy.h"
+
+// Monte Carlo tree search: every thread grows its own tree of the next
+// moves from random rollouts until the time budget is up, and the move
+// the trees visited most is played. The threads beyond the caller's come
+// from one pool the whole process shares, so many searches at once never
+// use more threads than there are CPUs. Time bound, so its games are not
+// repeatable the way the other policies' are.
+extern const Policy mcts_policy;
+
+// rollouts the last choice ran, on all threads together
+long mcts_rollouts(void const *state);
+
+#endif // !MCTS_H
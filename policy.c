@@ -0,0 +1,702 @@
+#include "policy.h"
+#include "hamcycle.h"
+#include "mcts.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const enum DIRECTION directions[4] = {
+    DIRECTION_left,
+    DIRECTION_right,
+    DIRECTION_up,
+    DIRECTION_down,
+};
+
+Pose policy_step(Pose pos, enum DIRECTION dir) {
+    switch (dir) {
+    case DIRECTION_left:
+        pos.x--;
+        break;
+    case DIRECTION_right:
+        pos.x++;
+        break;
+    case DIRECTION_up:
+        pos.y--;
+        break;
+    case DIRECTION_down:
+        pos.y++;
+        break;
+    default:
+        break;
+    }
+    return pos;
+}
+
+static enum DIRECTION policy_opposite(enum DIRECTION dir) {
+    switch (dir) {
+    case DIRECTION_left:
+        return DIRECTION_right;
+    case DIRECTION_right:
+        return DIRECTION_left;
+    case DIRECTION_up:
+        return DIRECTION_down;
+    case DIRECTION_down:
+        return DIRECTION_up;
+    default:
+        return DIRECTION_null;
+    }
+}
+
+bool policy_safe(Snake const *snake, enum DIRECTION dir) {
+    // snake_set_direction ignores reversals, even for a lone head
+    if (dir == policy_opposite(snake->dir)) {
+        return false;
+    }
+    Pose next_pos = policy_step(snake_get_head(snake), dir);
+    return !snake_pos_out_of_bounds(snake, next_pos) &&
+           !snake_contains_pos(snake, next_pos);
+}
+
+// the i-th cell of the body counting from the head
+static Pose policy_body(Snake const *snake, int i) {
+    int length = snake->deq->length;
+    return deque_get(snake->deq, snake->flipped ? length - 1 - i : i);
+}
+
+static void *random_create(int nlines, int ncols, uint64_t seed) {
+    Rng *rng = malloc(sizeof *rng);
+    if (rng != NULL) {
+        rng_seed(rng, seed);
+    }
+    return rng;
+}
+
+static void random_destroy(void *state) {
+    free(state);
+}
+
+static void random_reset(void *state, uint64_t seed) {
+    rng_seed(state, seed);
+}
+
+// uniform over the moves that survive the next tick
+static enum DIRECTION random_choose(void *state, Snake const *snake) {
+    enum DIRECTION safe[4];
+    int nsafe = 0;
+    for (int i = 0; i < 4; i++) {
+        if (policy_safe(snake, directions[i])) {
+            safe[nsafe++] = directions[i];
+        }
+    }
+    if (nsafe == 0) {
+        return snake->dir == DIRECTION_null ? DIRECTION_up : snake->dir;
+    }
+    return safe[rng_below(state, nsafe)];
+}
+
+// safe move that closes the most distance to the food, random on ties
+static enum DIRECTION greedy_choose(void *state, Snake const *snake) {
+    Pose head = snake_get_head(snake);
+    enum DIRECTION best = DIRECTION_null;
+    int best_dist = 0;
+    int nties = 0;
+    for (int i = 0; i < 4; i++) {
+        if (policy_safe(snake, directions[i]) == false) {
+            continue;
+        }
+        Pose next_pos = policy_step(head, directions[i]);
+        int dist = abs(next_pos.y - snake->food_pos.y) +
+                   abs(next_pos.x - snake->food_pos.x);
+        if (best == DIRECTION_null || dist < best_dist) {
+            best = directions[i];
+            best_dist = dist;
+            nties = 1;
+        } else if (dist == best_dist && rng_below(state, ++nties) == 0) {
+            best = directions[i];
+        }
+    }
+    if (best == DIRECTION_null) {
+        return snake->dir == DIRECTION_null ? DIRECTION_up : snake->dir;
+    }
+    return best;
+}
+
+// Breadth first search scratch for the bfs policy. The board is kept with a
+// one cell wall around it so a neighbor is a fixed offset away and needs no
+// bounds check. Each search stamps the cells it reaches with a fresh
+// generation instead of clearing the board, and the board's blocked cells
+// are stamped the same way, so a tick costs only the cells searched and
+// nothing is allocated after create.
+typedef struct Bfs {
+    int nlines;
+    int ncols;
+    // cells per row, walls included
+    int width;
+    int ncells;
+    // cell offsets in the order of directions
+    int offset[4];
+    uint32_t generation;
+    // the generation of the search that reached each cell, and its
+    // distance from that search's start
+    uint32_t *seen;
+    int *dist;
+    int *queue;
+    // walls carry BFS_WALL, above every generation
+    uint32_t blocked_generation;
+    uint32_t *blocked;
+    // the plan being followed: cells from the head to the food, a meal
+    // away from a board where the tail can still be reached
+    int *path;
+    int path_length;
+    int path_next;
+    int plan_start;
+    Pose plan_food;
+    Rng rng;
+} Bfs;
+
+#define BFS_WALL UINT32_MAX
+
+static void bfs_build_walls(Bfs *bfs) {
+    for (int cell = 0; cell < bfs->ncells; cell++) {
+        int y = cell / bfs->width;
+        int x = cell % bfs->width;
+        if (y == 0 || y > bfs->nlines || x == 0 || x > bfs->ncols) {
+            bfs->blocked[cell] = BFS_WALL;
+        }
+    }
+}
+
+static void *bfs_create(int nlines, int ncols, uint64_t seed) {
+    Bfs *bfs = calloc(1, sizeof *bfs);
+    if (bfs == NULL) {
+        return NULL;
+    }
+    bfs->nlines = nlines;
+    bfs->ncols = ncols;
+    bfs->width = ncols + 2;
+    bfs->ncells = (nlines + 2) * bfs->width;
+    bfs->offset[0] = -1;
+    bfs->offset[1] = 1;
+    bfs->offset[2] = -bfs->width;
+    bfs->offset[3] = bfs->width;
+    int ncells = bfs->ncells;
+    bfs->seen = calloc(ncells, sizeof *bfs->seen);
+    bfs->dist = malloc(ncells * sizeof *bfs->dist);
+    bfs->queue = malloc(4 * ncells * sizeof *bfs->queue);
+    bfs->blocked = calloc(ncells, sizeof *bfs->blocked);
+    bfs->path = malloc(ncells * sizeof *bfs->path);
+    if (bfs->seen == NULL || bfs->dist == NULL || bfs->queue == NULL ||
+        bfs->blocked == NULL || bfs->path == NULL) {
+        free(bfs->seen);
+        free(bfs->dist);
+        free(bfs->queue);
+        free(bfs->blocked);
+        free(bfs->path);
+        free(bfs);
+        return NULL;
+    }
+    bfs_build_walls(bfs);
+    rng_seed(&bfs->rng, seed);
+    return bfs;
+}
+
+static void bfs_destroy(void *state) {
+    Bfs *bfs = state;
+    free(bfs->seen);
+    free(bfs->dist);
+    free(bfs->queue);
+    free(bfs->blocked);
+    free(bfs->path);
+    free(bfs);
+}
+
+static void bfs_reset(void *state, uint64_t seed) {
+    Bfs *bfs = state;
+    bfs->path_length = 0;
+    rng_seed(&bfs->rng, seed);
+}
+
+// a generation no cell carries yet; the stamps start over, walls kept,
+// before reaching BFS_WALL
+static uint32_t bfs_next_generation(uint32_t *generation, uint32_t *stamps,
+                                    int ncells) {
+    if (++*generation == BFS_WALL) {
+        for (int i = 0; i < ncells; i++) {
+            if (stamps[i] != BFS_WALL) {
+                stamps[i] = 0;
+            }
+        }
+        *generation = 1;
+    }
+    return *generation;
+}
+
+static int bfs_cell(Bfs const *bfs, Pose pos) {
+    return (pos.y + 1) * bfs->width + pos.x + 1;
+}
+
+static enum DIRECTION bfs_direction(Bfs const *bfs, int from, int to) {
+    int i = 0;
+    while (i < 3 && from + bfs->offset[i] != to) {
+        i++;
+    }
+    return directions[i];
+}
+
+// stamps count cells of the body, from the first'th counting from the head,
+// walking the deque's ring directly; returns the last one
+static int bfs_stamp_body(Bfs *bfs, Snake const *snake, int first, int count,
+                          uint32_t stamp) {
+    Deque const *deq = snake->deq;
+    int step = snake->flipped ? -1 : 1;
+    int index = deq->front +
+                (snake->flipped ? deq->length - 1 - first : first);
+    if (index >= deq->capacity) {
+        index -= deq->capacity;
+    }
+    int cell = -1;
+    for (int i = 0; i < count; i++) {
+        Pose pos = deq->data[index];
+        cell = (pos.y + 1) * bfs->width + pos.x + 1;
+        bfs->blocked[cell] = stamp;
+        index += step;
+        if (index == deq->capacity) {
+            index = 0;
+        } else if (index < 0) {
+            index = deq->capacity - 1;
+        }
+    }
+    return cell;
+}
+
+// blocks the snake's body, and the cell behind a lone head since
+// snake_set_direction ignores turning back into it
+static void bfs_block_snake(Bfs *bfs, Snake const *snake) {
+    uint32_t gen = bfs_next_generation(&bfs->blocked_generation,
+                                       bfs->blocked, bfs->ncells);
+    bfs_stamp_body(bfs, snake, 0, snake->deq->length, gen);
+    if (snake->deq->length == 1 && snake->dir != DIRECTION_null) {
+        Pose behind = policy_step(snake_get_head(snake),
+                                  policy_opposite(snake->dir));
+        if (snake_pos_out_of_bounds(snake, behind) == false) {
+            bfs->blocked[bfs_cell(bfs, behind)] = gen;
+        }
+    }
+}
+
+// distances from start over unblocked cells, stopping early once all
+// ngoals cells in goals are reached; goals may be blocked themselves.
+// Returns how many of them were reached
+static int bfs_search_goals(Bfs *bfs, int start, int const *goals,
+                            int ngoals) {
+    uint32_t gen = bfs_next_generation(&bfs->generation, bfs->seen,
+                                       bfs->ncells);
+    uint32_t blocked_gen = bfs->blocked_generation;
+    uint32_t *seen = bfs->seen;
+    uint32_t const *blocked = bfs->blocked;
+    int *dist = bfs->dist;
+    int *queue = bfs->queue;
+    int head = 0;
+    int tail = 0;
+    int left = ngoals;
+
+    seen[start] = gen;
+    dist[start] = 0;
+    for (int g = 0; g < ngoals; g++) {
+        left -= goals[g] == start;
+    }
+    queue[tail++] = start;
+    while (head < tail && left > 0) {
+        int cell = queue[head++];
+        int next_dist = dist[cell] + 1;
+        for (int i = 0; i < 4; i++) {
+            int next = cell + bfs->offset[i];
+            if (seen[next] == gen) {
+                continue;
+            }
+            bool goal = false;
+            for (int g = 0; g < ngoals; g++) {
+                goal |= goals[g] == next;
+            }
+            // stale stamps are below the current generation, walls above;
+            // a blocked goal is reached but not gone through
+            bool open = blocked[next] < blocked_gen;
+            if (open == false && goal == false) {
+                continue;
+            }
+            seen[next] = gen;
+            dist[next] = next_dist;
+            if (open) {
+                queue[tail++] = next;
+            }
+            if (goal && --left == 0) {
+                break;
+            }
+        }
+    }
+    return ngoals - left;
+}
+
+// the distance from start to goal over unblocked cells, -1 if it cannot
+// be reached; goal may be blocked itself
+static int bfs_search(Bfs *bfs, int start, int goal) {
+    if (bfs_search_goals(bfs, start, &goal, 1) == 0) {
+        return -1;
+    }
+    return bfs->dist[goal];
+}
+
+// true if goal can be reached from start over unblocked cells; goal may be
+// blocked itself. Floods from both ends a cell at a time until they meet or
+// either runs out, so a walled in end gives up after the few cells it has.
+// Each end tries the moves toward the other's origin first, crossing open
+// ground in about as many cells as the distance. Leaves no distances behind
+static bool bfs_reachable(Bfs *bfs, int start, int goal) {
+    uint32_t gen[2];
+    gen[0] = bfs_next_generation(&bfs->generation, bfs->seen, bfs->ncells);
+    gen[1] = bfs_next_generation(&bfs->generation, bfs->seen, bfs->ncells);
+    uint32_t blocked_gen = bfs->blocked_generation;
+    uint32_t *seen = bfs->seen;
+    uint32_t const *blocked = bfs->blocked;
+    // one deque per end, each in its half of the buffer: toward moves
+    // pushed in front, the others at the back
+    int *queue[2] = {bfs->queue + bfs->ncells, bfs->queue + 3 * bfs->ncells};
+    int head[2] = {0, 0};
+    int tail[2] = {1, 1};
+    int target_y[2] = {goal / bfs->width, start / bfs->width};
+    int target_x[2] = {goal % bfs->width, start % bfs->width};
+
+    if (start == goal) {
+        return true;
+    }
+    seen[start] = gen[0];
+    seen[goal] = gen[1];
+    queue[0][0] = start;
+    queue[1][0] = goal;
+    while (head[0] < tail[0] && head[1] < tail[1]) {
+        for (int side = 0; side < 2; side++) {
+            int cell = queue[side][head[side]++];
+            int y = cell / bfs->width;
+            int x = cell % bfs->width;
+            bool toward[4] = {
+                target_x[side] < x,
+                target_x[side] > x,
+                target_y[side] < y,
+                target_y[side] > y,
+            };
+            for (int i = 0; i < 4; i++) {
+                int next = cell + bfs->offset[i];
+                if (seen[next] == gen[side ^ 1]) {
+                    return true;
+                }
+                if (seen[next] == gen[side] || blocked[next] >= blocked_gen) {
+                    continue;
+                }
+                seen[next] = gen[side];
+                if (toward[i]) {
+                    queue[side][--head[side]] = next;
+                } else {
+                    queue[side][tail[side]++] = next;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// true if the last search reached cell
+static bool bfs_reached(Bfs const *bfs, int cell) {
+    return bfs->seen[cell] == bfs->generation;
+}
+
+// walks the last search back from goal, which it reached in length steps,
+// into path, start excluded
+static void bfs_trace(Bfs *bfs, int goal, int length) {
+    int cell = goal;
+    for (int d = length; d > 0; d--) {
+        bfs->path[d - 1] = cell;
+        for (int i = 0; i < 4; i++) {
+            int prev = cell + bfs->offset[i];
+            if (bfs_reached(bfs, prev) && bfs->dist[prev] == d - 1) {
+                cell = prev;
+                break;
+            }
+        }
+    }
+    bfs->path_length = length;
+}
+
+// blocks the body the snake would have after following path to the food,
+// the path reversed and then the old body, one longer; returns its tail.
+// Starts from the snake as bfs_block_snake left it and only stamps what
+// changes: the path, and the end of the old body the meal leaves behind
+static int bfs_block_fed_snake(Bfs *bfs, Snake const *snake) {
+    uint32_t gen = bfs->blocked_generation;
+    int length = snake->deq->length + 1;
+    int kept = length > bfs->path_length ? length - bfs->path_length : 0;
+    bfs_stamp_body(bfs, snake, kept, snake->deq->length - kept, 0);
+    // a lone head had the cell behind it blocked too, which it has left
+    if (snake->deq->length == 1 && snake->dir != DIRECTION_null) {
+        Pose behind = policy_step(snake_get_head(snake),
+                                  policy_opposite(snake->dir));
+        if (snake_pos_out_of_bounds(snake, behind) == false) {
+            bfs->blocked[bfs_cell(bfs, behind)] = 0;
+        }
+    }
+    int tail = bfs->path[bfs->path_length - 1];
+    for (int i = 0; i < length && i < bfs->path_length; i++) {
+        tail = bfs->path[bfs->path_length - 1 - i];
+        bfs->blocked[tail] = gen;
+    }
+    if (kept > 0) {
+        tail = bfs_stamp_body(bfs, snake, kept - 1, 1, gen);
+    }
+    return tail;
+}
+
+// true while the head is where the plan expects and its next cell is free
+static bool bfs_on_plan(Bfs const *bfs, Snake const *snake) {
+    if (bfs->path_next >= bfs->path_length ||
+        pose_equal(bfs->plan_food, snake->food_pos) == false) {
+        return false;
+    }
+    int head = bfs_cell(bfs, snake_get_head(snake));
+    int expected =
+        bfs->path_next == 0 ? bfs->plan_start : bfs->path[bfs->path_next - 1];
+    return head == expected &&
+           policy_safe(snake, bfs_direction(bfs, head,
+                                            bfs->path[bfs->path_next]));
+}
+
+// shortest path to the food if the tail can still be reached after eating,
+// otherwise the safe move that stays farthest from the tail, buying time
+// for the body to open a way; a plan is followed until it breaks
+static enum DIRECTION bfs_choose(void *state, Snake const *snake) {
+    Bfs *bfs = state;
+    int head = bfs_cell(bfs, snake_get_head(snake));
+
+    if (bfs_on_plan(bfs, snake) == false) {
+        bfs->path_length = 0;
+        bfs_block_snake(bfs, snake);
+        int food = bfs_cell(bfs, snake->food_pos);
+        int length = bfs_search(bfs, head, food);
+        if (length > 0) {
+            bfs_trace(bfs, food, length);
+            int tail = bfs_block_fed_snake(bfs, snake);
+            // a body filling the board has won, there is no tail to find
+            if (snake->deq->length + 1 == bfs->nlines * bfs->ncols ||
+                bfs_reachable(bfs, food, tail)) {
+                bfs->path_next = 0;
+                bfs->plan_start = head;
+                bfs->plan_food = snake->food_pos;
+            } else {
+                bfs->path_length = 0;
+            }
+        }
+    }
+    if (bfs->path_length > 0) {
+        return bfs_direction(bfs, head, bfs->path[bfs->path_next++]);
+    }
+
+    // the tail's search only runs until it has reached every safe move
+    bfs_block_snake(bfs, snake);
+    int tail = bfs_cell(bfs, snake->flipped ? deque_get_head(snake->deq)
+                                            : deque_get_tail(snake->deq));
+    Pose head_pos = snake_get_head(snake);
+    int moves[4];
+    int nmoves = 0;
+    for (int i = 0; i < 4; i++) {
+        if (policy_safe(snake, directions[i])) {
+            moves[nmoves++] =
+                bfs_cell(bfs, policy_step(head_pos, directions[i]));
+        }
+    }
+    bfs_search_goals(bfs, tail, moves, nmoves);
+    enum DIRECTION best = DIRECTION_null;
+    int best_dist = -1;
+    for (int i = 0; i < 4; i++) {
+        if (policy_safe(snake, directions[i]) == false) {
+            continue;
+        }
+        int next = bfs_cell(bfs, policy_step(head_pos, directions[i]));
+        int dist = bfs_reached(bfs, next) ? bfs->dist[next] : -1;
+        if (best == DIRECTION_null || dist > best_dist) {
+            best = directions[i];
+            best_dist = dist;
+        }
+    }
+    if (best == DIRECTION_null) {
+        return random_choose(&bfs->rng, snake);
+    }
+    return best;
+}
+
+// Follows a Hamiltonian cycle, which wins on any board that has one, and
+// cuts across it toward the food while the snake is short. The body always
+// lies in cycle order from the tail to the head, so a cut is safe as long
+// as it lands ahead of the head and short of the tail.
+typedef struct Hamilton {
+    HamCycle *cycle;
+    int ncells;
+    // the cell the last choice moved to, -1 to check the body's order
+    int expected_head;
+    // false after a flip or hand steering left the body out of cycle order
+    bool ordered;
+    Rng rng;
+} Hamilton;
+
+// cuts stop this many cells short of the tail, so eating on landing
+// still leaves the next cycle cell free
+#define HAMILTON_TAIL_GAP 2
+
+static void *hamilton_create(int nlines, int ncols, uint64_t seed) {
+    char buf[HAMCYCLE_DIR_MAX];
+    Hamilton *ham = malloc(sizeof *ham);
+    if (ham == NULL) {
+        return NULL;
+    }
+    ham->cycle =
+        hamcycle_open(nlines, ncols, hamcycle_default_dir(buf, sizeof buf));
+    if (ham->cycle == NULL) {
+        free(ham);
+        return NULL;
+    }
+    ham->ncells = nlines * ncols;
+    ham->expected_head = -1;
+    ham->ordered = false;
+    rng_seed(&ham->rng, seed);
+    return ham;
+}
+
+static void hamilton_destroy(void *state) {
+    Hamilton *ham = state;
+    hamcycle_close(ham->cycle);
+    free(ham);
+}
+
+static void hamilton_reset(void *state, uint64_t seed) {
+    Hamilton *ham = state;
+    ham->expected_head = -1;
+    rng_seed(&ham->rng, seed);
+}
+
+static int hamilton_order(Hamilton const *ham, Pose pos) {
+    return ham->cycle->order[pos.y * ham->cycle->ncols + pos.x];
+}
+
+// cells from a to b going forward along the cycle
+static int hamilton_dist(Hamilton const *ham, int a, int b) {
+    return b >= a ? b - a : b - a + ham->ncells;
+}
+
+// true if each cell from the tail to the head is ahead of the one before,
+// going round the cycle at most once
+static bool hamilton_body_ordered(Hamilton const *ham, Snake const *snake) {
+    int length = snake->deq->length;
+    int prev = hamilton_order(ham, policy_body(snake, length - 1));
+    int span = 0;
+    for (int i = length - 2; i >= 0; i--) {
+        int next = hamilton_order(ham, policy_body(snake, i));
+        span += hamilton_dist(ham, prev, next);
+        prev = next;
+    }
+    return span < ham->ncells;
+}
+
+// the cycle's next cell, or a cut toward the food that keeps the order;
+// with the body out of order it follows the cycle where it can until the
+// body has wound back into it
+static enum DIRECTION hamilton_choose(void *state, Snake const *snake) {
+    Hamilton *ham = state;
+    Pose head = snake_get_head(snake);
+    int ncols = ham->cycle->ncols;
+    if (ham->expected_head != head.y * ncols + head.x) {
+        ham->ordered = hamilton_body_ordered(ham, snake);
+    }
+
+    int at = hamilton_order(ham, head);
+    int tail = hamilton_order(ham, policy_body(snake, snake->deq->length - 1));
+    // a lone head has the whole cycle ahead of it
+    int to_tail = snake->deq->length == 1 ? ham->ncells
+                                          : hamilton_dist(ham, at, tail);
+    int to_food = hamilton_dist(ham, at, hamilton_order(ham, snake->food_pos));
+    // half the board or more is no room for cutting corners
+    bool cut = ham->ordered && snake->deq->length * 2 < ham->ncells;
+
+    enum DIRECTION best = DIRECTION_null;
+    int best_step = 0;
+    for (int i = 0; i < 4; i++) {
+        if (policy_safe(snake, directions[i]) == false) {
+            continue;
+        }
+        Pose next_pos = policy_step(head, directions[i]);
+        int step = hamilton_dist(ham, at, hamilton_order(ham, next_pos));
+        bool along = step == 1;
+        bool shortcut = cut && step <= to_food &&
+                        step <= to_tail - HAMILTON_TAIL_GAP - 1;
+        if ((along || shortcut) && step > best_step) {
+            best = directions[i];
+            best_step = step;
+        }
+    }
+    if (best == DIRECTION_null) {
+        best = random_choose(&ham->rng, snake);
+        ham->ordered = false;
+    }
+    Pose next = policy_step(head, best);
+    ham->expected_head = next.y * ncols + next.x;
+    return best;
+}
+
+static const Policy random_policy = {
+    .name = "random",
+    .create = random_create,
+    .destroy = random_destroy,
+    .reset = random_reset,
+    .choose = random_choose,
+};
+
+static const Policy greedy_policy = {
+    .name = "greedy",
+    .create = random_create,
+    .destroy = random_destroy,
+    .reset = random_reset,
+    .choose = greedy_choose,
+};
+
+static const Policy bfs_policy = {
+    .name = "bfs",
+    .create = bfs_create,
+    .destroy = bfs_destroy,
+    .reset = bfs_reset,
+    .choose = bfs_choose,
+};
+
+static const Policy hamilton_policy = {
+    .name = "hamilton",
+    .create = hamilton_create,
+    .destroy = hamilton_destroy,
+    .reset = hamilton_reset,
+    .choose = hamilton_choose,
+};
+
+static Policy const *const policies[] = {
+    &random_policy,
+    &greedy_policy,
+    &bfs_policy,
+    &hamilton_policy,
+    &mcts_policy,
+    NULL,
+};
+
+Policy const *policy_find(const char *name) {
+    for (int i = 0; policies[i] != NULL; i++) {
+        if (strcmp(policies[i]->name, name) == 0) {
+            return policies[i];
+        }
+    }
+    return NULL;
+}
+
+Policy const *const *policy_all(void) {
+    return policies;
+}
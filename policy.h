@@ -0,0 +1,30 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "snakecore.h"
+#include <stdint.h>
+
+// a direction chooser for headless play; state is private to one worker
+typedef struct Policy {
+    const char *name;
+    void *(*create)(int nlines, int ncols, uint64_t seed);
+    void (*destroy)(void *state);
+    // called before every game so results do not depend on scheduling
+    void (*reset)(void *state, uint64_t seed);
+    enum DIRECTION (*choose)(void *state, Snake const *snake);
+    // how long one choice may think, NULL for policies that do not search
+    void (*set_budget)(void *state, int64_t budget_ns);
+} Policy;
+
+// returns NULL for an unknown name
+Policy const *policy_find(const char *name);
+
+// NULL terminated list of the built-in policies
+Policy const *const *policy_all(void);
+
+Pose policy_step(Pose pos, enum DIRECTION dir);
+
+// true if moving in dir does not immediately hit a wall or the body
+bool policy_safe(Snake const *snake, enum DIRECTION dir);
+
+#endif // !POLICY_H
@@ -0,0 +1,626 @@
+#define _POSIX_C_SOURCE 200809L
+#define NCURSES_WIDECHAR 1
+
+#include <errno.h>
+#include <ncurses/curses.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include "renderer.h"
+
+// the longest escape sequences the ANSI backend sends for one cell: a cursor
+// position, a color change and a 4 byte UTF-8 sequence
+#define ANSI_CUP_MAX 16
+#define ANSI_SGR_MAX 24
+#define ANSI_CELL_MAX (ANSI_CUP_MAX + ANSI_SGR_MAX + 4)
+// a front cell that matches nothing
+#define ANSI_STALE UINT32_MAX
+
+struct Renderer
+{
+    RendererBackend const *backend;
+    void *state;
+    int nlines;
+    int ncols;
+};
+
+static void
+terminal_size(int *nlines, int *ncols)
+{
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 &&
+        ws.ws_col > 0)
+    {
+        *nlines = ws.ws_row;
+        *ncols = ws.ws_col;
+    }
+    else
+    {
+        *nlines = LINES;
+        *ncols = COLS;
+    }
+}
+
+// curses: everything is drawn on stdscr and doupdate works out the changes
+
+static void *
+curses_create(int nlines, int ncols)
+{
+    return stdscr;
+}
+
+static void
+curses_destroy(void *state)
+{
+}
+
+static void
+curses_set_pair(void *state, int pair, int fg, int bg)
+{
+    init_pair(pair, fg, bg);
+}
+
+// the line drawing characters go through the alternate character set, so
+// they work without a UTF-8 locale
+static chtype
+curses_acs(uint32_t ch)
+{
+    switch (ch)
+    {
+    case RENDERER_HLINE:
+        return ACS_HLINE;
+    case RENDERER_VLINE:
+        return ACS_VLINE;
+    case RENDERER_ULCORNER:
+        return ACS_ULCORNER;
+    case RENDERER_URCORNER:
+        return ACS_URCORNER;
+    case RENDERER_LLCORNER:
+        return ACS_LLCORNER;
+    case RENDERER_LRCORNER:
+        return ACS_LRCORNER;
+    case RENDERER_TTEE:
+        return ACS_TTEE;
+    case RENDERER_BTEE:
+        return ACS_BTEE;
+    case RENDERER_FULL_BLOCK:
+        return MB_CUR_MAX == 1 ? ACS_BLOCK : 0;
+    default:
+        return 0;
+    }
+}
+
+static void
+curses_put(void *state, int y, int x, uint32_t ch, int pair)
+{
+    chtype acs = curses_acs(ch);
+    if (ch < 0x80)
+    {
+        mvwaddch(state, y, x, ch | COLOR_PAIR(pair));
+    }
+    else if (acs != 0)
+    {
+        mvwaddch(state, y, x, acs | COLOR_PAIR(pair));
+    }
+    else
+    {
+        wchar_t wch[2] = {ch, L'\0'};
+        cchar_t cell;
+        setcchar(&cell, wch, A_NORMAL, pair, NULL);
+        mvwadd_wch(state, y, x, &cell);
+    }
+}
+
+static void
+curses_blank(void *state)
+{
+    werase(state);
+}
+
+static void
+curses_flush(void *state)
+{
+    wnoutrefresh(state);
+    doupdate();
+}
+
+static bool
+curses_resize(void *state, int nlines, int ncols)
+{
+    resizeterm(nlines, ncols);
+    werase(state);
+    clearok(curscr, TRUE);
+    return true;
+}
+
+static RendererBackend const renderer_curses = {
+    .name = "curses",
+    .create = curses_create,
+    .destroy = curses_destroy,
+    .set_pair = curses_set_pair,
+    .put = curses_put,
+    .blank = curses_blank,
+    .flush = curses_flush,
+    .resize = curses_resize,
+    .threadable = false,
+};
+
+// ansi: front and back cell buffers, the difference goes out as escape
+// sequences built in one preallocated buffer and sent with one write(2)
+
+typedef struct AnsiCell
+{
+    uint32_t ch;
+    int pair;
+}
+AnsiCell;
+
+typedef struct AnsiState
+{
+    int nlines;
+    int ncols;
+    // what the views drew
+    AnsiCell *back;
+    // what the terminal shows
+    AnsiCell *front;
+    // per row, the columns put since the last flush, first > last if none
+    int *first;
+    int *last;
+    char *out;
+    size_t out_size;
+    char sgr[RENDERER_PAIRS][ANSI_SGR_MAX];
+    // where the terminal's cursor and colors are, -1 if unknown
+    int cursor_y;
+    int cursor_x;
+    int pair;
+}
+AnsiState;
+
+// forgets what the terminal shows, so the next flush sends every cell
+static void
+ansi_invalidate(AnsiState *ansi)
+{
+    size_t ncells = (size_t) ansi->nlines * ansi->ncols;
+    for (size_t i = 0; i < ncells; i++)
+    {
+        ansi->front[i] = (AnsiCell) {.ch = ANSI_STALE, .pair = 0};
+    }
+    for (int y = 0; y < ansi->nlines; y++)
+    {
+        ansi->first[y] = 0;
+        ansi->last[y] = ansi->ncols - 1;
+    }
+    ansi->cursor_y = -1;
+    ansi->cursor_x = -1;
+    ansi->pair = -1;
+}
+
+static bool
+ansi_alloc(AnsiState *ansi, int nlines, int ncols)
+{
+    size_t ncells = (size_t) nlines * ncols;
+    AnsiCell *back = malloc(ncells * sizeof *back);
+    AnsiCell *front = malloc(ncells * sizeof *front);
+    size_t out_size = ncells * ANSI_CELL_MAX + ANSI_SGR_MAX;
+    char *out = malloc(out_size);
+    int *first = malloc(nlines * sizeof *first);
+    int *last = malloc(nlines * sizeof *last);
+    if (back == NULL || front == NULL || out == NULL || first == NULL ||
+        last == NULL)
+    {
+        free(back);
+        free(front);
+        free(out);
+        free(first);
+        free(last);
+        return false;
+    }
+
+    free(ansi->back);
+    free(ansi->front);
+    free(ansi->out);
+    free(ansi->first);
+    free(ansi->last);
+    ansi->back = back;
+    ansi->front = front;
+    ansi->out = out;
+    ansi->first = first;
+    ansi->last = last;
+    ansi->out_size = out_size;
+    ansi->nlines = nlines;
+    ansi->ncols = ncols;
+    for (size_t i = 0; i < ncells; i++)
+    {
+        back[i] = (AnsiCell) {.ch = ' ', .pair = 0};
+    }
+    ansi_invalidate(ansi);
+    return true;
+}
+
+static void *
+ansi_create(int nlines, int ncols)
+{
+    // cells go out as UTF-8 whatever the locale, so insist on one
+    if (MB_CUR_MAX == 1)
+    {
+        return NULL;
+    }
+    AnsiState *ansi = calloc(1, sizeof *ansi);
+    if (ansi == NULL)
+    {
+        return NULL;
+    }
+    if (ansi_alloc(ansi, nlines, ncols) == false)
+    {
+        free(ansi);
+        return NULL;
+    }
+    for (int i = 0; i < RENDERER_PAIRS; i++)
+    {
+        strcpy(ansi->sgr[i], "\x1b[0m");
+    }
+    return ansi;
+}
+
+static void
+ansi_destroy(void *state)
+{
+    AnsiState *ansi = state;
+    free(ansi->back);
+    free(ansi->front);
+    free(ansi->out);
+    free(ansi->first);
+    free(ansi->last);
+    free(ansi);
+}
+
+static void
+ansi_set_pair(void *state, int pair, int fg, int bg)
+{
+    AnsiState *ansi = state;
+    char fgs[4] = "39";
+    char bgs[4] = "49";
+    if (fg >= 0)
+    {
+        snprintf(fgs, sizeof fgs, "3%d", fg & 7);
+    }
+    if (bg >= 0)
+    {
+        snprintf(bgs, sizeof bgs, "4%d", bg & 7);
+    }
+    snprintf(ansi->sgr[pair], ANSI_SGR_MAX, "\x1b[0;%s;%sm", fgs, bgs);
+}
+
+static void
+ansi_put(void *state, int y, int x, uint32_t ch, int pair)
+{
+    AnsiState *ansi = state;
+    ansi->back[y * ansi->ncols + x] = (AnsiCell) {.ch = ch, .pair = pair};
+    ansi->first[y] = x < ansi->first[y] ? x : ansi->first[y];
+    ansi->last[y] = x > ansi->last[y] ? x : ansi->last[y];
+}
+
+static void
+ansi_blank(void *state)
+{
+    AnsiState *ansi = state;
+    size_t ncells = (size_t) ansi->nlines * ansi->ncols;
+    for (size_t i = 0; i < ncells; i++)
+    {
+        ansi->back[i] = (AnsiCell) {.ch = ' ', .pair = 0};
+    }
+    for (int y = 0; y < ansi->nlines; y++)
+    {
+        ansi->first[y] = 0;
+        ansi->last[y] = ansi->ncols - 1;
+    }
+}
+
+static int
+ansi_utf8(char *p, uint32_t ch)
+{
+    if (ch < 0x80)
+    {
+        p[0] = ch;
+        return 1;
+    }
+    else if (ch < 0x800)
+    {
+        p[0] = 0xc0 | ch >> 6;
+        p[1] = 0x80 | (ch & 0x3f);
+        return 2;
+    }
+    else if (ch < 0x10000)
+    {
+        p[0] = 0xe0 | ch >> 12;
+        p[1] = 0x80 | (ch >> 6 & 0x3f);
+        p[2] = 0x80 | (ch & 0x3f);
+        return 3;
+    }
+    p[0] = 0xf0 | ch >> 18;
+    p[1] = 0x80 | (ch >> 12 & 0x3f);
+    p[2] = 0x80 | (ch >> 6 & 0x3f);
+    p[3] = 0x80 | (ch & 0x3f);
+    return 4;
+}
+
+static int
+ansi_ndigits(int n)
+{
+    int ndigits = 1;
+    while (n >= 10)
+    {
+        n /= 10;
+        ndigits++;
+    }
+    return ndigits;
+}
+
+// moves the cursor right along row y to x the cheapest way: rewriting the
+// unchanged cells in between when they are in the current colors and that
+// is shorter than a cursor forward
+static char *
+ansi_move(AnsiState *ansi, char *p, int y, int x)
+{
+    if (ansi->cursor_y == y && ansi->cursor_x < x)
+    {
+        int gap = x - ansi->cursor_x;
+        int cuf_len = 3 + ansi_ndigits(gap);
+        AnsiCell const *row = &ansi->back[y * ansi->ncols];
+        int len = 0;
+        for (int i = ansi->cursor_x; i < x && len <= cuf_len; i++)
+        {
+            len = row[i].pair == ansi->pair ? len + (row[i].ch < 0x80 ? 1 : 3)
+                                            : cuf_len + 1;
+        }
+        if (len <= cuf_len)
+        {
+            for (int i = ansi->cursor_x; i < x; i++)
+            {
+                p += ansi_utf8(p, row[i].ch);
+            }
+        }
+        else
+        {
+            p += sprintf(p, "\x1b[%dC", gap);
+        }
+    }
+    else
+    {
+        p += sprintf(p, "\x1b[%d;%dH", y + 1, x + 1);
+    }
+    ansi->cursor_y = y;
+    ansi->cursor_x = x;
+    return p;
+}
+
+static void
+ansi_flush(void *state)
+{
+    AnsiState *ansi = state;
+    char *p = ansi->out;
+    for (int y = 0; y < ansi->nlines; y++)
+    {
+        AnsiCell *back = &ansi->back[y * ansi->ncols];
+        AnsiCell *front = &ansi->front[y * ansi->ncols];
+        // only the columns put to can differ from the terminal
+        int first = ansi->first[y];
+        int last = ansi->last[y];
+        ansi->first[y] = ansi->ncols;
+        ansi->last[y] = -1;
+        for (int x = first; x <= last; x++)
+        {
+            if (back[x].ch == front[x].ch && back[x].pair == front[x].pair)
+            {
+                continue;
+            }
+            if (ansi->cursor_y != y || ansi->cursor_x != x)
+            {
+                p = ansi_move(ansi, p, y, x);
+            }
+            if (back[x].pair != ansi->pair)
+            {
+                p = stpcpy(p, ansi->sgr[back[x].pair]);
+                ansi->pair = back[x].pair;
+            }
+            p += ansi_utf8(p, back[x].ch);
+            front[x] = back[x];
+            ansi->cursor_x++;
+            // terminals disagree on where the cursor is after the last column
+            if (ansi->cursor_x == ansi->ncols)
+            {
+                ansi->cursor_y = -1;
+            }
+        }
+    }
+
+    char *q = ansi->out;
+    while (q < p)
+    {
+        ssize_t n = write(STDOUT_FILENO, q, p - q);
+        if (n < 0 && errno != EINTR)
+        {
+            // whatever did not arrive is sent again on the next flush
+            ansi_invalidate(ansi);
+            return;
+        }
+        q += n > 0 ? n : 0;
+    }
+}
+
+static bool
+ansi_resize(void *state, int nlines, int ncols)
+{
+    return ansi_alloc(state, nlines, ncols);
+}
+
+static RendererBackend const renderer_ansi = {
+    .name = "ansi",
+    .create = ansi_create,
+    .destroy = ansi_destroy,
+    .set_pair = ansi_set_pair,
+    .put = ansi_put,
+    .blank = ansi_blank,
+    .flush = ansi_flush,
+    .resize = ansi_resize,
+    .threadable = true,
+};
+
+static RendererBackend const *const renderers[] = {
+    &renderer_ansi,
+    &renderer_curses,
+    NULL,
+};
+
+RendererBackend const *
+renderer_find(const char *name)
+{
+    for (RendererBackend const *const *r = renderers; *r != NULL; r++)
+    {
+        if (strcmp((*r)->name, name) == 0)
+        {
+            return *r;
+        }
+    }
+    return NULL;
+}
+
+RendererBackend const *const *
+renderer_all(void)
+{
+    return renderers;
+}
+
+Renderer *
+renderer_new(RendererBackend const *backend)
+{
+    Renderer *renderer = malloc(sizeof *renderer);
+    if (renderer == NULL)
+    {
+        return NULL;
+    }
+    terminal_size(&renderer->nlines, &renderer->ncols);
+    renderer->backend = backend;
+    renderer->state = backend->create(renderer->nlines, renderer->ncols);
+    if (renderer->state == NULL)
+    {
+        free(renderer);
+        return NULL;
+    }
+    return renderer;
+}
+
+void
+renderer_destroy(Renderer *renderer)
+{
+    renderer->backend->destroy(renderer->state);
+    free(renderer);
+}
+
+void
+renderer_size(Renderer const *renderer, int *nlines, int *ncols)
+{
+    *nlines = renderer->nlines;
+    *ncols = renderer->ncols;
+}
+
+bool
+renderer_threadable(Renderer const *renderer)
+{
+    return renderer->backend->threadable;
+}
+
+void
+renderer_set_pair(Renderer *renderer, int pair, int fg, int bg)
+{
+    renderer->backend->set_pair(renderer->state, pair, fg, bg);
+}
+
+void
+renderer_put(Renderer *renderer, int y, int x, uint32_t ch, int pair)
+{
+    if (y < 0 || y >= renderer->nlines || x < 0 || x >= renderer->ncols)
+    {
+        return;
+    }
+    renderer->backend->put(renderer->state, y, x, ch, pair);
+}
+
+void
+renderer_text(Renderer *renderer, int y, int x, int ncols, int pair,
+              const char *fmt, ...)
+{
+    char buf[256];
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(buf, sizeof buf, fmt, ap);
+    va_end(ap);
+    len = len < 0 ? 0 : len >= (int) sizeof buf ? (int) sizeof buf - 1 : len;
+
+    for (int i = 0; i < ncols; i++)
+    {
+        renderer_put(renderer, y, x + i, i < len ? buf[i] : ' ', pair);
+    }
+}
+
+void
+renderer_fill(Renderer *renderer, int y, int x, int nlines, int ncols,
+              uint32_t ch, int pair)
+{
+    for (int i = 0; i < nlines; i++)
+    {
+        for (int j = 0; j < ncols; j++)
+        {
+            renderer_put(renderer, y + i, x + j, ch, pair);
+        }
+    }
+}
+
+void
+renderer_box(Renderer *renderer, int y, int x, int nlines, int ncols,
+             int pair)
+{
+    int bottom = y + nlines - 1;
+    int right = x + ncols - 1;
+    renderer_put(renderer, y, x, RENDERER_ULCORNER, pair);
+    renderer_put(renderer, y, right, RENDERER_URCORNER, pair);
+    renderer_put(renderer, bottom, x, RENDERER_LLCORNER, pair);
+    renderer_put(renderer, bottom, right, RENDERER_LRCORNER, pair);
+    renderer_fill(renderer, y, x + 1, 1, ncols - 2, RENDERER_HLINE, pair);
+    renderer_fill(renderer, bottom, x + 1, 1, ncols - 2, RENDERER_HLINE, pair);
+    renderer_fill(renderer, y + 1, x, nlines - 2, 1, RENDERER_VLINE, pair);
+    renderer_fill(renderer, y + 1, right, nlines - 2, 1, RENDERER_VLINE, pair);
+}
+
+void
+renderer_clear(Renderer *renderer)
+{
+    renderer->backend->blank(renderer->state);
+}
+
+void
+renderer_flush(Renderer *renderer)
+{
+    renderer->backend->flush(renderer->state);
+}
+
+void
+renderer_resize(Renderer *renderer)
+{
+    int nlines, ncols;
+    terminal_size(&nlines, &ncols);
+    if (renderer->backend->resize(renderer->state, nlines, ncols))
+    {
+        renderer->nlines = nlines;
+        renderer->ncols = ncols;
+    }
+    else
+    {
+        // out of memory: stay at the old size, clipped but consistent
+        renderer->backend->resize(renderer->state, renderer->nlines,
+                                  renderer->ncols);
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// The views draw into a grid of screen cells, each a Unicode code point in
+// one of a few color pairs, and renderer_flush brings the terminal up to
+// date with it. Backends differ only in how they get there. Curses must be
+// initialized first either way, it still owns input and the terminal modes.
+
+// pair 0 is the terminal's default colors
+#define RENDERER_PAIRS 8
+
+// code points the views draw with besides ASCII
+#define RENDERER_HLINE 0x2500
+#define RENDERER_VLINE 0x2502
+#define RENDERER_ULCORNER 0x250c
+#define RENDERER_URCORNER 0x2510
+#define RENDERER_LLCORNER 0x2514
+#define RENDERER_LRCORNER 0x2518
+#define RENDERER_TTEE 0x252c
+#define RENDERER_BTEE 0x2534
+#define RENDERER_UPPER_HALF 0x2580
+#define RENDERER_LOWER_HALF 0x2584
+#define RENDERER_FULL_BLOCK 0x2588
+
+typedef struct RendererBackend
+{
+    const char *name;
+    // NULL if the terminal cannot be driven this way
+    void *(*create)(int nlines, int ncols);
+    void (*destroy)(void *state);
+    // colors are curses COLOR_ numbers, -1 for the terminal default
+    void (*set_pair)(void *state, int pair, int fg, int bg);
+    void (*put)(void *state, int y, int x, uint32_t ch, int pair);
+    // blanks every cell, the terminal keeps its contents until the flush
+    void (*blank)(void *state);
+    void (*flush)(void *state);
+    // takes a new size, blank, and repaints every cell on the next flush;
+    // false if it could not, leaving the old size as it was
+    bool (*resize)(void *state, int nlines, int ncols);
+    // true if it may draw on another thread than the one reading keys;
+    // curses keeps one state for both, so it may not
+    bool threadable;
+}
+RendererBackend;
+
+typedef struct Renderer Renderer;
+
+// returns NULL for an unknown name
+RendererBackend const *
+renderer_find(const char *name);
+
+// NULL terminated list of the built-in backends in the order they are tried
+// when none is asked for
+RendererBackend const *const *
+renderer_all(void);
+
+// sized to the terminal; NULL if the backend could not start
+Renderer *
+renderer_new(RendererBackend const *backend);
+
+void
+renderer_destroy(Renderer *renderer);
+
+void
+renderer_size(Renderer const *renderer, int *nlines, int *ncols);
+
+// whether the backend may draw off the thread that reads input
+bool
+renderer_threadable(Renderer const *renderer);
+
+void
+renderer_set_pair(Renderer *renderer, int pair, int fg, int bg);
+
+// cells off the screen are ignored
+void
+renderer_put(Renderer *renderer, int y, int x, uint32_t ch, int pair);
+
+// prints ASCII text padded with spaces or cut to ncols columns
+void
+renderer_text(Renderer *renderer, int y, int x, int ncols, int pair,
+              const char *fmt, ...) __attribute__((format(printf, 6, 7)));
+
+void
+renderer_fill(Renderer *renderer, int y, int x, int nlines, int ncols,
+              uint32_t ch, int pair);
+
+// a line border around nlines by ncols cells starting at y, x
+void
+renderer_box(Renderer *renderer, int y, int x, int nlines, int ncols,
+             int pair);
+
+void
+renderer_clear(Renderer *renderer);
+
+void
+renderer_flush(Renderer *renderer);
+
+// follows the terminal to its current size, blank until redrawn
+void
+renderer_resize(Renderer *renderer);
+
+#endif // !RENDERER_H
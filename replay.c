@@ -0,0 +1,779 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "replay.h"
+
+#define REPLAY_MAGIC "SNKR"
+#define REPLAY_INDEX_MAGIC "SNKI"
+#define REPLAY_HEADER_SIZE 32
+#define REPLAY_V1_HEADER_SIZE 28
+#define REPLAY_INDEX_ENTRY_SIZE 16
+#define REPLAY_FOOTER_SIZE 16
+#define REPLAY_WRITE_BUFFER 65536
+// longest varint for a 64 and a 32 bit value
+#define VARINT_MAX 10
+#define VARINT32_MAX 5
+// everything in a keyframe payload but the cells
+#define KEYFRAME_FIXED (6 * VARINT_MAX + 3 + 8)
+
+typedef struct ReplayIndexEntry
+{
+    int64_t tick;
+    uint64_t offset;
+}
+ReplayIndexEntry;
+
+struct ReplayWriter
+{
+    int fd;
+    ReplayHeader header;
+    int64_t last_tick;
+    int64_t next_keyframe;
+    // what a player has reached by last_tick, stored in keyframes
+    uint32_t delay_us;
+    int continues;
+    int games;
+    ReplayIndexEntry *index;
+    int nindex;
+    int index_capacity;
+    uint8_t *keyframe;
+    // file offset of buffer[0]
+    uint64_t offset;
+    size_t length;
+    bool failed;
+    uint8_t buffer[REPLAY_WRITE_BUFFER];
+};
+
+struct ReplayReader
+{
+    uint8_t const *data;
+    size_t size;
+    size_t start;
+    // events stop where the index begins
+    size_t end;
+    size_t pos;
+    int64_t last_tick;
+    ReplayHeader header;
+    uint8_t const *index;
+    int nindex;
+    // keyframe decoding scratch
+    Pose *body;
+    int *free_cells;
+};
+
+static void
+put_u32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        p[i] = v >> (8 * i);
+    }
+}
+
+static void
+put_u64(uint8_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        p[i] = v >> (8 * i);
+    }
+}
+
+static uint32_t
+get_u32(uint8_t const *p)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        v |= (uint32_t) p[i] << (8 * i);
+    }
+    return v;
+}
+
+static uint64_t
+get_u64(uint8_t const *p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        v |= (uint64_t) p[i] << (8 * i);
+    }
+    return v;
+}
+
+static size_t
+put_varint(uint8_t *p, uint64_t v)
+{
+    size_t n = 0;
+    while (v >= 0x80)
+    {
+        p[n++] = (v & 0x7f) | 0x80;
+        v >>= 7;
+    }
+    p[n++] = v;
+    return n;
+}
+
+static bool
+get_varint(uint8_t const *p, size_t size, size_t *pos, uint64_t *v)
+{
+    *v = 0;
+    for (int shift = 0; shift < 64 && *pos < size; shift += 7)
+    {
+        uint8_t byte = p[(*pos)++];
+        *v |= (uint64_t) (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool
+write_all(int fd, uint8_t const *p, size_t n)
+{
+    while (n > 0)
+    {
+        ssize_t written = write(fd, p, n);
+        if (written < 0)
+        {
+            return false;
+        }
+        p += written;
+        n -= written;
+    }
+    return true;
+}
+
+ReplayWriter *
+replay_writer_open(const char *path, ReplayHeader const *header)
+{
+    ReplayWriter *writer = malloc(sizeof *writer);
+    if (writer == NULL)
+    {
+        return NULL;
+    }
+    int ncells = header->nlines * header->ncols;
+    writer->keyframe = malloc(KEYFRAME_FIXED + (size_t) ncells * VARINT32_MAX);
+    writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (writer->keyframe == NULL || writer->fd < 0)
+    {
+        if (writer->fd >= 0)
+        {
+            close(writer->fd);
+        }
+        free(writer->keyframe);
+        free(writer);
+        return NULL;
+    }
+    writer->header = *header;
+    writer->last_tick = 0;
+    writer->next_keyframe = header->keyframe_interval;
+    writer->delay_us = header->delay_us;
+    writer->continues = 0;
+    writer->games = 1;
+    writer->index = NULL;
+    writer->nindex = 0;
+    writer->index_capacity = 0;
+    writer->offset = 0;
+    writer->failed = false;
+
+    uint8_t *p = writer->buffer;
+    memcpy(p, REPLAY_MAGIC, 4);
+    p[4] = REPLAY_VERSION;
+    p[5] = p[6] = p[7] = 0;
+    put_u32(p + 8, header->nlines);
+    put_u32(p + 12, header->ncols);
+    put_u64(p + 16, header->seed);
+    put_u32(p + 24, header->delay_us);
+    put_u32(p + 28, header->keyframe_interval);
+    writer->length = REPLAY_HEADER_SIZE;
+
+    return writer;
+}
+
+// buffers n bytes, writing straight through when they would not fit
+static bool
+replay_writer_append(ReplayWriter *writer, uint8_t const *p, size_t n)
+{
+    if (writer->length + n > REPLAY_WRITE_BUFFER &&
+        replay_writer_flush(writer) == false)
+    {
+        return false;
+    }
+    if (n > REPLAY_WRITE_BUFFER)
+    {
+        if (write_all(writer->fd, p, n) == false)
+        {
+            writer->failed = true;
+        }
+        writer->offset += n;
+        return writer->failed == false;
+    }
+    memcpy(writer->buffer + writer->length, p, n);
+    writer->length += n;
+    return true;
+}
+
+bool
+replay_writer_event(ReplayWriter *writer, int64_t tick, enum REPLAY_EVENT type,
+                    uint32_t arg)
+{
+    uint8_t record[2 * VARINT_MAX + 1];
+    size_t n = put_varint(record, tick - writer->last_tick);
+    record[n++] = type;
+    if (type == REPLAY_EVENT_delay)
+    {
+        n += put_varint(record + n, arg);
+    }
+    writer->last_tick = tick;
+
+    // track what the next keyframe has to carry besides the snake
+    switch (type)
+    {
+    case REPLAY_EVENT_delay:
+        writer->delay_us = arg;
+        break;
+    case REPLAY_EVENT_continue:
+        writer->continues++;
+        break;
+    case REPLAY_EVENT_restart:
+        writer->delay_us = writer->header.delay_us;
+        writer->continues = 0;
+        writer->games++;
+        break;
+    default:
+        break;
+    }
+
+    return replay_writer_append(writer, record, n);
+}
+
+static size_t
+replay_encode_cell(uint8_t *p, Snake const *snake, Pose pos)
+{
+    return put_varint(p, pos.y * snake->ncols + pos.x);
+}
+
+// payload: varint delay_us, varint continues, varint games, u8 dir,
+// u8 state, u8 flipped, varint food cell, u64 rng state, varint length,
+// the body cells in deque order and then the free list in order
+static size_t
+replay_encode_keyframe(ReplayWriter *writer, Snake const *snake)
+{
+    uint8_t *p = writer->keyframe;
+    size_t n = 0;
+    n += put_varint(p + n, writer->delay_us);
+    n += put_varint(p + n, writer->continues);
+    n += put_varint(p + n, writer->games);
+    p[n++] = snake->dir;
+    p[n++] = snake->state;
+    p[n++] = snake->flipped;
+    n += replay_encode_cell(p + n, snake, snake->food_pos);
+    put_u64(p + n, snake->rng.state);
+    n += 8;
+    n += put_varint(p + n, snake->deq->length);
+    for (int i = 0; i < snake->deq->length; i++)
+    {
+        n += replay_encode_cell(p + n, snake, deque_get(snake->deq, i));
+    }
+    for (int i = 0; i < snake->nfree; i++)
+    {
+        n += put_varint(p + n, snake->free_cells[i]);
+    }
+    return n;
+}
+
+bool
+replay_writer_tick(ReplayWriter *writer, int64_t tick, Snake const *snake)
+{
+    if (writer->header.keyframe_interval == 0 || tick < writer->next_keyframe)
+    {
+        return true;
+    }
+    writer->next_keyframe = tick + writer->header.keyframe_interval;
+
+    if (writer->nindex == writer->index_capacity)
+    {
+        int capacity = writer->index_capacity ? writer->index_capacity * 2 : 64;
+        ReplayIndexEntry *index =
+            realloc(writer->index, capacity * sizeof *index);
+        if (index == NULL)
+        {
+            return false;
+        }
+        writer->index = index;
+        writer->index_capacity = capacity;
+    }
+    writer->index[writer->nindex++] = (ReplayIndexEntry) {
+        .tick = tick,
+        .offset = writer->offset + writer->length,
+    };
+
+    size_t payload = replay_encode_keyframe(writer, snake);
+    uint8_t record[2 * VARINT_MAX + 1];
+    size_t n = put_varint(record, tick - writer->last_tick);
+    record[n++] = REPLAY_EVENT_keyframe;
+    n += put_varint(record + n, payload);
+    writer->last_tick = tick;
+
+    return replay_writer_append(writer, record, n) &&
+           replay_writer_append(writer, writer->keyframe, payload);
+}
+
+bool
+replay_writer_flush(ReplayWriter *writer)
+{
+    if (writer->failed == false &&
+        write_all(writer->fd, writer->buffer, writer->length) == false)
+    {
+        writer->failed = true;
+    }
+    writer->offset += writer->length;
+    writer->length = 0;
+    return writer->failed == false;
+}
+
+static bool
+replay_writer_index(ReplayWriter *writer)
+{
+    uint64_t index_offset = writer->offset + writer->length;
+    uint8_t entry[REPLAY_INDEX_ENTRY_SIZE];
+    for (int i = 0; i < writer->nindex; i++)
+    {
+        put_u64(entry, writer->index[i].tick);
+        put_u64(entry + 8, writer->index[i].offset);
+        if (replay_writer_append(writer, entry, sizeof entry) == false)
+        {
+            return false;
+        }
+    }
+
+    uint8_t footer[REPLAY_FOOTER_SIZE];
+    put_u64(footer, index_offset);
+    put_u32(footer + 8, writer->nindex);
+    memcpy(footer + 12, REPLAY_INDEX_MAGIC, 4);
+    return replay_writer_append(writer, footer, sizeof footer);
+}
+
+bool
+replay_writer_close(ReplayWriter *writer)
+{
+    bool ok = replay_writer_index(writer);
+    ok = replay_writer_flush(writer) && ok;
+    if (close(writer->fd) != 0)
+    {
+        ok = false;
+    }
+    free(writer->index);
+    free(writer->keyframe);
+    free(writer);
+    return ok;
+}
+
+// finds the index from the footer, leaving the events running to the end
+// of the file when there is none
+static void
+replay_reader_find_index(ReplayReader *reader)
+{
+    reader->end = reader->size;
+    if (reader->size < reader->start + REPLAY_FOOTER_SIZE)
+    {
+        return;
+    }
+    uint8_t const *footer = reader->data + reader->size - REPLAY_FOOTER_SIZE;
+    uint64_t index_offset = get_u64(footer);
+    uint64_t nindex = get_u32(footer + 8);
+    if (memcmp(footer + 12, REPLAY_INDEX_MAGIC, 4) != 0 ||
+        index_offset < reader->start ||
+        index_offset + nindex * REPLAY_INDEX_ENTRY_SIZE !=
+            reader->size - REPLAY_FOOTER_SIZE)
+    {
+        return;
+    }
+    reader->end = index_offset;
+    reader->index = reader->data + index_offset;
+    reader->nindex = nindex;
+}
+
+ReplayReader *
+replay_reader_open(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    struct stat st;
+    ReplayReader *reader = calloc(1, sizeof *reader);
+    if (reader == NULL || fstat(fd, &st) != 0 ||
+        st.st_size < REPLAY_V1_HEADER_SIZE)
+    {
+        free(reader);
+        close(fd);
+        return NULL;
+    }
+
+    reader->size = st.st_size;
+    void *data = mmap(NULL, reader->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        free(reader);
+        return NULL;
+    }
+    reader->data = data;
+
+    uint8_t const *p = reader->data;
+    reader->header = (ReplayHeader) {
+        .nlines = get_u32(p + 8),
+        .ncols = get_u32(p + 12),
+        .seed = get_u64(p + 16),
+        .delay_us = get_u32(p + 24),
+    };
+    // version 1 files predate keyframes and the index
+    reader->start = REPLAY_V1_HEADER_SIZE;
+    if (p[4] == REPLAY_VERSION && reader->size >= REPLAY_HEADER_SIZE)
+    {
+        reader->header.keyframe_interval = get_u32(p + 28);
+        reader->start = REPLAY_HEADER_SIZE;
+    }
+    if (memcmp(p, REPLAY_MAGIC, 4) != 0 ||
+        (p[4] != 1 && p[4] != REPLAY_VERSION) || reader->header.nlines <= 0 ||
+        reader->header.ncols <= 0 || reader->header.delay_us == 0)
+    {
+        replay_reader_close(reader);
+        return NULL;
+    }
+    if (p[4] == REPLAY_VERSION)
+    {
+        replay_reader_find_index(reader);
+    }
+    else
+    {
+        reader->end = reader->size;
+    }
+
+    int ncells = reader->header.nlines * reader->header.ncols;
+    reader->body = malloc(ncells * sizeof *reader->body);
+    reader->free_cells = malloc(ncells * sizeof *reader->free_cells);
+    if (reader->body == NULL || reader->free_cells == NULL)
+    {
+        replay_reader_close(reader);
+        return NULL;
+    }
+    reader->pos = reader->start;
+
+    return reader;
+}
+
+void
+replay_reader_close(ReplayReader *reader)
+{
+    munmap((void *) reader->data, reader->size);
+    free(reader->body);
+    free(reader->free_cells);
+    free(reader);
+}
+
+ReplayHeader
+replay_reader_header(ReplayReader const *reader)
+{
+    return reader->header;
+}
+
+int
+replay_reader_keyframes(ReplayReader const *reader)
+{
+    return reader->nindex;
+}
+
+bool
+replay_reader_next(ReplayReader *reader, ReplayEvent *event)
+{
+    uint64_t delta;
+    uint64_t arg = 0;
+    uint8_t type;
+
+    // keyframes only matter when seeking
+    do
+    {
+        if (get_varint(reader->data, reader->end, &reader->pos, &delta) ==
+                false ||
+            reader->pos >= reader->end)
+        {
+            return false;
+        }
+        type = reader->data[reader->pos++];
+        if (type < REPLAY_EVENT_left || type > REPLAY_EVENT_keyframe)
+        {
+            return false;
+        }
+        if ((type == REPLAY_EVENT_delay || type == REPLAY_EVENT_keyframe) &&
+            get_varint(reader->data, reader->end, &reader->pos, &arg) == false)
+        {
+            return false;
+        }
+        if (type == REPLAY_EVENT_keyframe)
+        {
+            if (arg > reader->end - reader->pos)
+            {
+                return false;
+            }
+            reader->pos += arg;
+        }
+        reader->last_tick += delta;
+    }
+    while (type == REPLAY_EVENT_keyframe);
+
+    *event = (ReplayEvent) {
+        .tick = reader->last_tick,
+        .type = type,
+        .arg = arg,
+    };
+    return true;
+}
+
+void
+replay_player_init(ReplayPlayer *player, ReplayReader *reader, Snake *model)
+{
+    player->reader = reader;
+    player->model = model;
+    player->tick = 0;
+    player->delay_us = replay_reader_header(reader).delay_us;
+    player->continues = 0;
+    player->games = 1;
+    player->has_next = replay_reader_next(reader, &player->next);
+}
+
+// mirrors what the controller does for the same key; false on quit
+static bool
+replay_player_apply(ReplayPlayer *player, ReplayEvent const *event)
+{
+    Snake *model = player->model;
+
+    switch (event->type)
+    {
+    case REPLAY_EVENT_left:
+    case REPLAY_EVENT_right:
+    case REPLAY_EVENT_up:
+    case REPLAY_EVENT_down:
+        snake_set_direction(model, (enum DIRECTION) event->type);
+        break;
+    case REPLAY_EVENT_flip:
+        snake_flip(model);
+        break;
+    case REPLAY_EVENT_delay:
+        player->delay_us = event->arg;
+        break;
+    case REPLAY_EVENT_continue:
+        player->continues++;
+        model->state = STATE_null;
+        snake_mark_all_dirty(model);
+        break;
+    case REPLAY_EVENT_restart:
+        snake_reset(model, rng_next(&model->rng));
+        player->delay_us = replay_reader_header(player->reader).delay_us;
+        player->continues = 0;
+        player->games++;
+        break;
+    case REPLAY_EVENT_quit:
+    case REPLAY_EVENT_keyframe:
+        return false;
+    }
+    return true;
+}
+
+bool
+replay_player_step(ReplayPlayer *player)
+{
+    while (player->has_next && player->next.tick == player->tick)
+    {
+        if (replay_player_apply(player, &player->next) == false)
+        {
+            player->has_next = false;
+            return false;
+        }
+        player->has_next = replay_reader_next(player->reader, &player->next);
+    }
+
+    // without a pending event an idle snake would wait forever
+    if (player->model->state != STATE_active)
+    {
+        return false;
+    }
+    snake_update(player->model);
+    player->tick++;
+    return true;
+}
+
+static bool
+replay_decode_cell(ReplayReader *reader, Snake const *snake, int *cell)
+{
+    uint64_t v;
+    if (get_varint(reader->data, reader->end, &reader->pos, &v) == false ||
+        v >= (uint64_t) snake->nlines * snake->ncols)
+    {
+        return false;
+    }
+    *cell = v;
+    return true;
+}
+
+// decodes the keyframe record at the reader's position into player and
+// its snake, leaving the reader just past it
+static bool
+replay_player_restore(ReplayPlayer *player, int64_t tick)
+{
+    ReplayReader *reader = player->reader;
+    Snake *snake = player->model;
+    int ncells = snake->nlines * snake->ncols;
+    uint64_t delta, payload, delay_us, continues, games, length;
+    int food;
+
+    // the record's tick comes from the index, its payload length is implied
+    if (get_varint(reader->data, reader->end, &reader->pos, &delta) == false ||
+        reader->pos + 1 > reader->end ||
+        reader->data[reader->pos++] != REPLAY_EVENT_keyframe ||
+        get_varint(reader->data, reader->end, &reader->pos, &payload) ==
+            false ||
+        get_varint(reader->data, reader->end, &reader->pos, &delay_us) ==
+            false ||
+        get_varint(reader->data, reader->end, &reader->pos, &continues) ==
+            false ||
+        get_varint(reader->data, reader->end, &reader->pos, &games) == false ||
+        reader->pos + 3 > reader->end)
+    {
+        return false;
+    }
+    uint8_t const *p = reader->data + reader->pos;
+    enum DIRECTION dir = p[0];
+    enum STATE state = p[1];
+    bool flipped = p[2];
+    reader->pos += 3;
+    if (dir > DIRECTION_down || state > STATE_active ||
+        replay_decode_cell(reader, snake, &food) == false ||
+        reader->pos + 8 > reader->end)
+    {
+        return false;
+    }
+    uint64_t rng_state = get_u64(reader->data + reader->pos);
+    reader->pos += 8;
+    if (get_varint(reader->data, reader->end, &reader->pos, &length) == false ||
+        length == 0 || length > (uint64_t) ncells)
+    {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < length; i++)
+    {
+        int cell;
+        if (replay_decode_cell(reader, snake, &cell) == false)
+        {
+            return false;
+        }
+        reader->body[i] = (Pose) {
+            .y = cell / snake->ncols,
+            .x = cell % snake->ncols,
+        };
+    }
+    for (uint64_t i = 0; i < ncells - length; i++)
+    {
+        if (replay_decode_cell(reader, snake, &reader->free_cells[i]) == false)
+        {
+            return false;
+        }
+    }
+    if (snake_restore_board(snake, reader->body, length, reader->free_cells) !=
+        SNAKE_ERROR_none)
+    {
+        return false;
+    }
+
+    snake->dir = dir;
+    snake->state = state;
+    snake->flipped = flipped;
+    snake->food_pos = (Pose) {
+        .y = food / snake->ncols,
+        .x = food % snake->ncols,
+    };
+    snake->rng.state = rng_state;
+    player->delay_us = delay_us;
+    player->continues = continues;
+    player->games = games;
+    player->tick = tick;
+    reader->last_tick = tick;
+    player->has_next = replay_reader_next(reader, &player->next);
+    return true;
+}
+
+// the last keyframe at or before tick, -1 if there is none
+static int
+replay_reader_find_keyframe(ReplayReader const *reader, int64_t tick)
+{
+    int lo = 0;
+    int hi = reader->nindex;
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if ((int64_t) get_u64(reader->index + mid * REPLAY_INDEX_ENTRY_SIZE) <=
+            tick)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo - 1;
+}
+
+bool
+replay_player_seek(ReplayPlayer *player, int64_t tick)
+{
+    ReplayReader *reader = player->reader;
+    int keyframe = replay_reader_find_keyframe(reader, tick);
+    int64_t keyframe_tick = 0;
+    uint64_t keyframe_offset = 0;
+    if (keyframe >= 0)
+    {
+        uint8_t const *entry =
+            reader->index + keyframe * REPLAY_INDEX_ENTRY_SIZE;
+        keyframe_tick = get_u64(entry);
+        keyframe_offset = get_u64(entry + 8);
+    }
+
+    if (keyframe >= 0 && (tick < player->tick || keyframe_tick > player->tick))
+    {
+        if (keyframe_offset < reader->start || keyframe_offset >= reader->end)
+        {
+            return false;
+        }
+        reader->pos = keyframe_offset;
+        if (replay_player_restore(player, keyframe_tick) == false)
+        {
+            return false;
+        }
+    }
+    else if (tick < player->tick)
+    {
+        // no keyframe to fall back on, start over
+        snake_reset(player->model, reader->header.seed);
+        reader->pos = reader->start;
+        reader->last_tick = 0;
+        replay_player_init(player, reader, player->model);
+    }
+
+    while (player->tick < tick && replay_player_step(player))
+    {
+    }
+    return player->tick == tick;
+}
@@ -0,0 +1,129 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "snakecore.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// A replay is a header, one record per input event, periodic keyframes and
+// an index of those keyframes (all little endian):
+//   "SNKR" u8 version, 3 reserved bytes, u32 nlines, u32 ncols, u64 seed,
+//   u32 initial tick period in microseconds, u32 ticks between keyframes
+//   event: varint ticks since the previous record, u8 type, [varint arg]
+//   keyframe: varint ticks since the previous record, u8 keyframe,
+//     varint payload length, payload (see replay_writer_tick)
+//   index: u64 tick, u64 file offset per keyframe, then u64 index offset,
+//     u32 keyframe count, "SNKI"
+// An event's tick is the number of snake_update calls made before it took
+// effect, counted across restarts. A keyframe at tick T holds the state
+// before any event of tick T. Files cut short by a crash have no index and
+// can only be seeked by re-simulating from the start.
+
+#define REPLAY_VERSION 2
+#define REPLAY_KEYFRAME_INTERVAL 1000
+
+enum REPLAY_EVENT
+{
+    // the direction events share their values with enum DIRECTION
+    REPLAY_EVENT_left = DIRECTION_left,
+    REPLAY_EVENT_right = DIRECTION_right,
+    REPLAY_EVENT_up = DIRECTION_up,
+    REPLAY_EVENT_down = DIRECTION_down,
+    REPLAY_EVENT_flip,
+    // arg is the new tick period in microseconds
+    REPLAY_EVENT_delay,
+    REPLAY_EVENT_continue,
+    REPLAY_EVENT_restart,
+    REPLAY_EVENT_quit,
+    // written by replay_writer_tick, never returned by replay_reader_next
+    REPLAY_EVENT_keyframe,
+};
+
+typedef struct ReplayHeader
+{
+    int nlines;
+    int ncols;
+    uint64_t seed;
+    uint32_t delay_us;
+    // 0 for no keyframes
+    uint32_t keyframe_interval;
+}
+ReplayHeader;
+
+typedef struct ReplayEvent
+{
+    int64_t tick;
+    enum REPLAY_EVENT type;
+    uint32_t arg;
+}
+ReplayEvent;
+
+typedef struct ReplayWriter ReplayWriter;
+
+typedef struct ReplayReader ReplayReader;
+
+// re-simulates a replay on a caller owned Snake, reset in place on restarts
+typedef struct ReplayPlayer
+{
+    ReplayReader *reader;
+    Snake *model;
+    int64_t tick;
+    uint32_t delay_us;
+    int continues;
+    int games;
+    ReplayEvent next;
+    bool has_next;
+}
+ReplayPlayer;
+
+// returns NULL if the file could not be created
+ReplayWriter *
+replay_writer_open(const char *path, ReplayHeader const *header);
+
+bool
+replay_writer_event(ReplayWriter *writer, int64_t tick, enum REPLAY_EVENT type,
+                    uint32_t arg);
+
+// call after every snake_update; writes a keyframe of snake when one is due
+bool
+replay_writer_tick(ReplayWriter *writer, int64_t tick, Snake const *snake);
+
+bool
+replay_writer_flush(ReplayWriter *writer);
+
+// writes the index, flushes and closes, false if anything could not be
+// written
+bool
+replay_writer_close(ReplayWriter *writer);
+
+// maps the file; returns NULL if it is missing or has a bad header
+ReplayReader *
+replay_reader_open(const char *path);
+
+void
+replay_reader_close(ReplayReader *reader);
+
+ReplayHeader
+replay_reader_header(ReplayReader const *reader);
+
+int
+replay_reader_keyframes(ReplayReader const *reader);
+
+// false at the end of the events or on a truncated record
+bool
+replay_reader_next(ReplayReader *reader, ReplayEvent *event);
+
+void
+replay_player_init(ReplayPlayer *player, ReplayReader *reader, Snake *model);
+
+// applies the events due at the current tick and runs at most one
+// snake_update; false once the recording is over
+bool
+replay_player_step(ReplayPlayer *player);
+
+// moves to tick, restoring the last keyframe at or before it when that is
+// closer than the current tick; false if the recording ends first
+bool
+replay_player_seek(ReplayPlayer *player, int64_t tick);
+
+#endif // !REPLAY_H
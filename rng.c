@@ -0,0 +1,32 @@
+#include "rng.h"
+
+void
+rng_seed(Rng *rng, uint64_t seed)
+{
+    // splitmix64 spreads small or similar seeds over the whole state
+    uint64_t z = seed + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z = z ^ (z >> 31);
+
+    // xorshift never leaves the all zero state
+    rng->state = z != 0 ? z : 0x9e3779b97f4a7c15ULL;
+}
+
+uint64_t
+rng_next(Rng *rng)
+{
+    uint64_t x = rng->state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    rng->state = x;
+    return x * 0x2545f4914f6cdd1dULL;
+}
+
+uint32_t
+rng_below(Rng *rng, uint32_t bound)
+{
+    // multiply-shift range reduction, no division on the hot path
+    return (uint32_t) (((rng_next(rng) >> 32) * bound) >> 32);
+}
@@ -0,0 +1,22 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// xorshift64* generator, small enough to snapshot and copy per game
+typedef struct Rng
+{
+    uint64_t state;
+}
+Rng;
+
+void
+rng_seed(Rng *rng, uint64_t seed);
+
+uint64_t
+rng_next(Rng *rng);
+
+uint32_t
+rng_below(Rng *rng, uint32_t bound);
+
+#endif // !RNG_H
@@ -0,0 +1,153 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include "scheduler.h"
+#include "timer.h"
+
+#define NS_PER_SEC 1000000000LL
+// the measured tick rate is recomputed over windows at least this long
+#define RATE_WINDOW_NS 250000000LL
+// short periods may catch up on this much time, not just max_catch_up ticks
+#define CATCH_UP_NS 10000000LL
+
+struct Scheduler
+{
+    int64_t period_ns;
+    int64_t deadline_ns;
+    int max_catch_up;
+    int64_t batch_ns;
+
+    int64_t window_start_ns;
+    int64_t window_ticks;
+    double tick_rate;
+
+    SchedulerStats stats;
+};
+
+Scheduler *
+scheduler_new(int64_t period_ns, int max_catch_up)
+{
+    Scheduler *sched = malloc(sizeof *sched);
+    if (sched == NULL)
+    {
+        return NULL;
+    }
+
+    sched->period_ns = period_ns;
+    sched->max_catch_up = max_catch_up < 1 ? 1 : max_catch_up;
+    sched->batch_ns = 0;
+    sched->stats = (SchedulerStats) {0};
+    sched->tick_rate = 0;
+    scheduler_reset(sched);
+
+    return sched;
+}
+
+void
+scheduler_destroy(Scheduler *sched)
+{
+    free(sched);
+}
+
+void
+scheduler_reset(Scheduler *sched)
+{
+    sched->deadline_ns = timer_now_ns() + sched->period_ns;
+    // time spent paused is not part of any window
+    sched->window_start_ns = 0;
+}
+
+void
+scheduler_set_period(Scheduler *sched, int64_t period_ns)
+{
+    // keep the phase: the pending deadline moves with the new period
+    sched->deadline_ns += period_ns - sched->period_ns;
+    sched->period_ns = period_ns;
+}
+
+void
+scheduler_set_batch_window(Scheduler *sched, int64_t batch_ns)
+{
+    sched->batch_ns = batch_ns;
+}
+
+int64_t
+scheduler_next_deadline(Scheduler const *sched)
+{
+    return sched->deadline_ns;
+}
+
+int
+scheduler_poll(Scheduler *sched, int64_t now)
+{
+    if (now < sched->deadline_ns)
+    {
+        return 0;
+    }
+
+    int64_t lateness = now - sched->deadline_ns;
+    int64_t behind = lateness / sched->period_ns + 1;
+    int64_t max_due = CATCH_UP_NS / sched->period_ns;
+    max_due = max_due > sched->max_catch_up ? max_due : sched->max_catch_up;
+    int due = behind > max_due ? max_due : behind;
+
+    // a batched poll is always up to a window behind its first tick, and
+    // may wake a little after the window
+    int64_t late_after = sched->batch_ns > sched->period_ns
+                             ? sched->batch_ns + sched->period_ns
+                             : sched->period_ns;
+    if (lateness >= late_after)
+    {
+        sched->stats.late_ticks++;
+    }
+    if (lateness > sched->stats.max_lateness_ns)
+    {
+        sched->stats.max_lateness_ns = lateness;
+    }
+    sched->stats.skipped_ticks += behind - due;
+    sched->deadline_ns += behind * sched->period_ns;
+
+    return due;
+}
+
+void
+scheduler_ran(Scheduler *sched, int n, int64_t now)
+{
+    if (n <= 0)
+    {
+        return;
+    }
+    sched->stats.ticks += n;
+
+    if (sched->window_start_ns == 0)
+    {
+        sched->window_start_ns = now;
+        sched->window_ticks = 0;
+        return;
+    }
+
+    sched->window_ticks += n;
+    int64_t elapsed = now - sched->window_start_ns;
+    if (elapsed >= RATE_WINDOW_NS)
+    {
+        sched->tick_rate = (double) sched->window_ticks * NS_PER_SEC / elapsed;
+        sched->window_start_ns = now;
+        sched->window_ticks = 0;
+    }
+}
+
+double
+scheduler_tick_rate(Scheduler const *sched)
+{
+    if (sched->tick_rate <= 0)
+    {
+        return (double) NS_PER_SEC / sched->period_ns;
+    }
+    return sched->tick_rate;
+}
+
+SchedulerStats
+scheduler_stats(Scheduler const *sched)
+{
+    return sched->stats;
+}
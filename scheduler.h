@@ -0,0 +1,60 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// fixed timestep ticks against absolute CLOCK_MONOTONIC deadlines, so the
+// time spent updating and drawing does not stretch the tick period
+typedef struct Scheduler Scheduler;
+
+typedef struct SchedulerStats
+{
+    int64_t ticks;
+    // polls that found ticks a whole period or more past their deadline;
+    // with a batch window longer than the period, that window and a period
+    int64_t late_ticks;
+    // ticks dropped because they were too far behind to catch up on
+    int64_t skipped_ticks;
+    int64_t max_lateness_ns;
+}
+SchedulerStats;
+
+Scheduler *
+scheduler_new(int64_t period_ns, int max_catch_up);
+
+void
+scheduler_destroy(Scheduler *sched);
+
+// starts a fresh schedule one period from now, e.g. after a pause
+void
+scheduler_reset(Scheduler *sched);
+
+void
+scheduler_set_period(Scheduler *sched, int64_t period_ns);
+
+// the caller polls no more often than every batch_ns, so ticks due within
+// that window of their deadline are on time; 0 by default
+void
+scheduler_set_batch_window(Scheduler *sched, int64_t batch_ns);
+
+int64_t
+scheduler_next_deadline(Scheduler const *sched);
+
+// number of ticks due at now, at most max_catch_up or 10 ms worth, whichever
+// is more; moves the deadline past them
+int
+scheduler_poll(Scheduler *sched, int64_t now);
+
+// reports that n ticks ran at now, for the measured tick rate
+void
+scheduler_ran(Scheduler *sched, int n, int64_t now);
+
+// measured ticks per second, or the nominal rate before any measurement
+double
+scheduler_tick_rate(Scheduler const *sched);
+
+SchedulerStats
+scheduler_stats(Scheduler const *sched);
+
+#endif // !SCHEDULER_H
@@ -1,12 +1,27 @@
-#include "deque.h"
+#define _GNU_SOURCE
+#include "alloccount.h"
+#include "eventloop.h"
+#include "histogram.h"
+#include "policy.h"
+#include "renderer.h"
+#include "replay.h"
+#include "scheduler.h"
+#include "snakecore.h"
+#include "statspage.h"
 #include "timer.h"
+#include "triplebuf.h"
+#include <errno.h>
 #include <locale.h>
 #include <math.h>
 #include <ncurses/curses.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 #define COLOR_SNAKE COLOR_GREEN
 #define PAIR_SNAKE 1
@@ -14,9 +29,27 @@
 #define PAIR_FOOD 2
 #define COLOR_BORDER COLOR_WHITE
 #define PAIR_BORDER 3
+// half-block cells with a differently colored top and bottom half
+#define PAIR_SNAKE_OVER_FOOD 4
+#define PAIR_FOOD_OVER_SNAKE 5
 
 #define INIT_DELAY_MS 100
+// f stops speeding up here, 20000 ticks a second
+#define MIN_DELAY_MS 0.05
+// ticks shorter than this run in batches, one wakeup per TICK_BATCH_NS
+#define TICK_BATCH_NS 1000000
+#define DEFAULT_FPS 60
+// ticks run back to back at most this many at a time when behind schedule
+#define MAX_CATCH_UP 4
+#define NS_PER_MS 1000000
+#define NS_PER_SEC 1000000000LL
+// direction keys pressed faster than the snake moves wait for their tick
+#define DIR_QUEUE_LEN 4
+// how far [ and ] jump in a rendered replay
+#define SEEK_TICKS 1000
 #define DEFAULT_LENGTH 15
+// how long an autopilot game's end screen stays up before the next game
+#define AUTOPILOT_RESTART_NS 2000000000LL
 
 #define END_NLINES 6
 #define END_NCOLS 19
@@ -26,423 +59,967 @@
 #define CONTINUES_NCOLS 11 + 2
 #define TIME_NCOLS 2 * 2 + 1
 
-enum DIRECTION {
-    DIRECTION_null,
-    DIRECTION_left,
-    DIRECTION_right,
-    DIRECTION_up,
-    DIRECTION_down,
+#define STATS_NLINES (3 + STAGE_count + 1)
+#define STATS_NCOLS (2 + 32 + 1)
+#define STATS_UPDATE_NS 250000000LL
+// how often the histograms are copied to the shared stats page
+#define PUBLISH_NS 100000000LL
+
+// how board cells map to terminal cells
+enum GLYPHS {
+    // 2x2 full block characters per cell
+    GLYPHS_block,
+    // two cells stacked in one terminal cell with half-block characters
+    GLYPHS_half,
+    // as GLYPHS_half, two columns wide to keep cells closer to square
+    GLYPHS_half_wide,
 };
 
-enum STATE {
-    STATE_null,
-    STATE_lose,
-    STATE_win,
-    STATE_active,
+// terminal rows and columns a board takes with the given glyphs
+void glyphs_view_size(enum GLYPHS glyphs, int nlines, int ncols,
+                      int *view_nlines, int *view_ncols) {
+    switch (glyphs) {
+    case GLYPHS_block:
+        *view_nlines = nlines * 2;
+        *view_ncols = ncols * 2;
+        break;
+    case GLYPHS_half:
+        *view_nlines = (nlines + 1) / 2;
+        *view_ncols = ncols;
+        break;
+    case GLYPHS_half_wide:
+        *view_nlines = (nlines + 1) / 2;
+        *view_ncols = ncols * 2;
+        break;
+    }
+}
+
+// the largest board that fits in a view_nlines by view_ncols area
+void glyphs_board_size(enum GLYPHS glyphs, int view_nlines, int view_ncols,
+                       int *nlines, int *ncols) {
+    switch (glyphs) {
+    case GLYPHS_block:
+        *nlines = view_nlines / 2;
+        *ncols = view_ncols / 2;
+        break;
+    case GLYPHS_half:
+        *nlines = view_nlines * 2;
+        *ncols = view_ncols;
+        break;
+    case GLYPHS_half_wide:
+        *nlines = view_nlines * 2;
+        *ncols = view_ncols / 2;
+        break;
+    }
+}
+
+enum CELL {
+    CELL_empty,
+    CELL_snake,
+    CELL_food,
 };
 
-typedef struct Snake {
+typedef struct SnakeView {
+    Renderer *renderer;
+    // screen position of the top left board cell, inside the border
+    int begin_y;
+    int begin_x;
     int nlines;
     int ncols;
-    enum DIRECTION dir;
-    enum STATE state;
-    bool flipped;
-    Deque *deq;
-    Pose food_pos;
-} Snake;
-
-Pose snake_find_food_pos(Snake *snake) {
-    bool **taken = malloc(snake->nlines * sizeof *taken);
-    for (int i = 0; i < snake->nlines; i++) {
-        taken[i] = calloc(1, snake->ncols * sizeof *taken[i]);
-    }
-
-    Node *cur = snake->deq->head->next;
-    while (cur != snake->deq->tail) {
-        int y = cur->data.y;
-        int x = cur->data.x;
-        taken[y][x] = true;
-
-        cur = cur->next;
-    }
-
-    int nth_empty =
-        rand() % (snake->nlines * snake->ncols - snake->deq->length);
-
-    int num_empty = 0;
-    Pose pos = {-1, -1};
-    for (int i = 0; i < snake->nlines; i++) {
-        for (int j = 0; j < snake->ncols; j++) {
-            if (taken[i][j] == false) {
-                if (num_empty == nth_empty) {
-                    pos = (Pose){.y = i, .x = j};
-                    goto cleanup;
-                }
-                num_empty++;
-            }
-        }
-    }
+    enum GLYPHS glyphs;
+    int board_nlines;
+    int board_ncols;
+    // an enum CELL per board cell, as last drawn
+    uint8_t *grid;
+    // the body and food last drawn, the next frame is diffed against them
+    Pose *body;
+    int length;
+    Pose food;
+} SnakeView;
 
-cleanup:
+void snakeview_draw_border(SnakeView *view) {
+    renderer_box(view->renderer, view->begin_y - 1, view->begin_x - 1,
+                 view->nlines + 2, view->ncols + 2, PAIR_BORDER);
+}
 
-    for (int i = 0; i < snake->nlines; i++) {
-        free(taken[i]);
-    }
-    free(taken);
+SnakeView *snakeview_new(Renderer *renderer, int board_nlines,
+                         int board_ncols, enum GLYPHS glyphs, int begin_y,
+                         int begin_x) {
 
-    if (pose_equal(pos, (Pose){-1, -1})) {
-        fprintf(stderr, "invalid snake_find_food_pos");
-        exit(1);
-    }
+    SnakeView *view = malloc(sizeof *view);
 
-    return pos;
+    view->renderer = renderer;
+    view->begin_y = begin_y;
+    view->begin_x = begin_x;
+    glyphs_view_size(glyphs, board_nlines, board_ncols, &view->nlines,
+                     &view->ncols);
+    view->glyphs = glyphs;
+    view->board_nlines = board_nlines;
+    view->board_ncols = board_ncols;
+    view->grid = calloc(board_nlines * board_ncols, sizeof *view->grid);
+    view->body = malloc(board_nlines * board_ncols * sizeof *view->body);
+    view->length = 0;
+    view->food = (Pose){.y = -1, .x = -1};
+
+    snakeview_draw_border(view);
+
+    return view;
+}
+
+void snakeview_destroy(SnakeView *view) {
+    free(view->grid);
+    free(view->body);
+    free(view);
 }
 
-Snake *snake_new(int nlines, int ncols) {
-    Snake *snake = malloc(sizeof *snake);
-    snake->nlines = nlines;
-    snake->ncols = ncols;
-    snake->deq = deque_new();
+void snakeview_put(SnakeView *view, int y, int x, uint32_t ch, int pair) {
+    renderer_put(view->renderer, view->begin_y + y, view->begin_x + x, ch,
+                 pair);
+}
 
-    snake->dir = DIRECTION_null;
-    snake->state = STATE_null;
-    snake->flipped = false;
+void snakeview_put_four(SnakeView *view, int y, int x, uint32_t ch,
+                        int pair) {
+    int y_tf = y * 2;
+    int x_tf = x * 2;
 
-    Node *first_node = node_new((Pose){.y = nlines / 2, .x = ncols / 2});
-    deque_push_back(snake->deq, first_node);
+    snakeview_put(view, y_tf, x_tf, ch, pair);
+    snakeview_put(view, y_tf, x_tf + 1, ch, pair);
+    snakeview_put(view, y_tf + 1, x_tf, ch, pair);
+    snakeview_put(view, y_tf + 1, x_tf + 1, ch, pair);
+}
 
-    snake->food_pos = snake_find_food_pos(snake);
+bool snakeview_in_bounds(SnakeView *view, Pose pos) {
+    return pos.y >= 0 && pos.y < view->board_nlines && pos.x >= 0 &&
+           pos.x < view->board_ncols;
+}
 
-    return snake;
+uint8_t *snakeview_grid(SnakeView *view, Pose pos) {
+    return &view->grid[pos.y * view->board_ncols + pos.x];
 }
 
-void snake_destroy(Snake *snake) {
-    deque_destroy(snake->deq);
-    free(snake);
+enum CELL snakeview_cell(SnakeView *view, Pose pos) {
+    if (snakeview_in_bounds(view, pos) == false) {
+        return CELL_empty;
+    }
+    return *snakeview_grid(view, pos);
 }
 
-void snake_set_direction(Snake *snake, enum DIRECTION dir) {
+// redraws the terminal cell shared by pos and its vertical neighbour
+void snakeview_draw_half(SnakeView *view, Pose pos) {
+    static const int pairs[] = {
+        [CELL_empty] = 0,
+        [CELL_snake] = PAIR_SNAKE,
+        [CELL_food] = PAIR_FOOD,
+    };
+    int top_y = pos.y & ~1;
+    enum CELL top = snakeview_cell(view, (Pose){.y = top_y, .x = pos.x});
+    enum CELL bottom =
+        snakeview_cell(view, (Pose){.y = top_y + 1, .x = pos.x});
+
+    uint32_t glyph = ' ';
+    int pair = 0;
+    if (top == bottom) {
+        glyph = top == CELL_empty ? ' ' : RENDERER_FULL_BLOCK;
+        pair = pairs[top];
+    } else if (bottom == CELL_empty) {
+        glyph = RENDERER_UPPER_HALF;
+        pair = pairs[top];
+    } else if (top == CELL_empty) {
+        glyph = RENDERER_LOWER_HALF;
+        pair = pairs[bottom];
+    } else {
+        glyph = RENDERER_UPPER_HALF;
+        pair = top == CELL_snake ? PAIR_SNAKE_OVER_FOOD : PAIR_FOOD_OVER_SNAKE;
+    }
 
-    switch (snake->dir) {
-    case DIRECTION_left:
-        if (dir != DIRECTION_right) {
-            snake->dir = dir;
-        }
-        break;
-    case DIRECTION_right:
-        if (dir != DIRECTION_left) {
-            snake->dir = dir;
-        }
-        break;
-    case DIRECTION_up:
-        if (dir != DIRECTION_down) {
-            snake->dir = dir;
-        }
-        break;
-    case DIRECTION_down:
-        if (dir != DIRECTION_up) {
-            snake->dir = dir;
-        }
-        break;
-    default:
-        snake->dir = dir;
-        break;
+    int width = view->glyphs == GLYPHS_half_wide ? 2 : 1;
+    for (int i = 0; i < width; i++) {
+        snakeview_put(view, top_y / 2, pos.x * width + i, glyph, pair);
     }
-    snake->state = STATE_active;
 }
 
-void snake_flip(Snake *snake) {
-    if (snake->dir == DIRECTION_null) {
-        return;
+void snakeview_draw_cell(SnakeView *view, Pose pos) {
+    enum CELL cell = snakeview_cell(view, pos);
+    if (view->glyphs != GLYPHS_block) {
+        snakeview_draw_half(view, pos);
+    } else if (cell == CELL_snake) {
+        snakeview_put_four(view, pos.y, pos.x, RENDERER_FULL_BLOCK,
+                           PAIR_SNAKE);
+    } else if (cell == CELL_food) {
+        snakeview_put_four(view, pos.y, pos.x, RENDERER_FULL_BLOCK,
+                           PAIR_FOOD);
+    } else {
+        snakeview_put_four(view, pos.y, pos.x, ' ', 0);
     }
+}
 
-    if (snake->deq->length == 0) {
-        fprintf(stderr, "snake has no nodes\n");
+void snakeview_set_cell(SnakeView *view, Pose pos, enum CELL cell) {
+    if (snakeview_in_bounds(view, pos) == false ||
+        *snakeview_grid(view, pos) == cell) {
         return;
     }
+    *snakeview_grid(view, pos) = cell;
+    snakeview_draw_cell(view, pos);
+}
 
-    if (snake->deq->length == 1) {
-        switch (snake->dir) {
-        case DIRECTION_left:
-            snake->dir = DIRECTION_right;
-            break;
-        case DIRECTION_right:
-            snake->dir = DIRECTION_left;
-            break;
-        case DIRECTION_up:
-            snake->dir = DIRECTION_down;
-            break;
-        case DIRECTION_down:
-            snake->dir = DIRECTION_up;
-            break;
-        default:
-            fprintf(stderr, "null direction\n");
+// sets body[begin] up to body[end] to cell
+void snakeview_set_cells(SnakeView *view, Pose const *body, int begin,
+                         int end, enum CELL cell) {
+    for (int i = begin; i < end; i++) {
+        snakeview_set_cell(view, body[i], cell);
+    }
+}
+
+// the run of cells the last drawn body and body share, starting at
+// *old_begin in the one and *new_begin in the other; a snake only grows and
+// shrinks at its ends, from either end of the ring after a flip, so one
+// body starts inside the other unless it was replaced
+int snakeview_common_span(SnakeView *view, Pose const *body, int length,
+                          int *old_begin, int *new_begin) {
+    *old_begin = 0;
+    *new_begin = 0;
+    if (view->length == 0 || length == 0) {
+        return 0;
+    }
+    int i = 0;
+    for (; i < length || i < view->length; i++) {
+        if (i < length && pose_equal(body[i], view->body[0])) {
+            *new_begin = i;
             break;
         }
-    } else {
-        Pose last_pos = snake->deq->tail->prev->data;
-        Pose second_last_pos = snake->deq->tail->prev->prev->data;
-        if (snake->flipped == true) {
-            last_pos = snake->deq->head->next->data;
-            second_last_pos = snake->deq->head->next->next->data;
+        if (i < view->length && pose_equal(view->body[i], body[0])) {
+            *old_begin = i;
+            break;
         }
-        Pose displacement = {.y = second_last_pos.y - last_pos.y,
-                             .x = second_last_pos.x - last_pos.x};
+    }
+    if (i == length && i >= view->length) {
+        return 0;
+    }
 
-        if (pose_equal(displacement, (Pose){.y = 0, .x = -1})) {
-            snake->dir = DIRECTION_right;
-        } else if (pose_equal(displacement, (Pose){.y = 0, .x = 1})) {
-            snake->dir = DIRECTION_left;
-        } else if (pose_equal(displacement, (Pose){.y = -1, .x = 0})) {
-            snake->dir = DIRECTION_down;
-        } else if (pose_equal(displacement, (Pose){.y = 1, .x = 0})) {
-            snake->dir = DIRECTION_up;
-        }
+    int span = view->length - *old_begin < length - *new_begin
+                   ? view->length - *old_begin
+                   : length - *new_begin;
+    while (span > 0 && pose_equal(view->body[*old_begin + span - 1],
+                                  body[*new_begin + span - 1]) == false) {
+        span--;
+    }
+    if (memcmp(&view->body[*old_begin], &body[*new_begin],
+               span * sizeof *body) != 0) {
+        return 0;
     }
-    snake->flipped = !snake->flipped;
-    snake->state = STATE_active;
+    return span;
 }
 
-bool snake_pos_out_of_bounds(Snake *snake, Pose pos) {
-    return (pos.y < 0 || pos.y > snake->nlines - 1 || pos.x < 0 ||
-            pos.x > snake->ncols - 1);
-}
+// draws the body, in deque order, and food, repainting only the cells that
+// changed since the last call unless all is set; frames may be skipped, so
+// the change is worked out from the two bodies rather than from the model
+void snakeview_redraw(SnakeView *view, Pose const *body, int length,
+                      Pose food, bool all) {
+    if (all == true) {
+        renderer_fill(view->renderer, view->begin_y, view->begin_x,
+                      view->nlines, view->ncols, ' ', 0);
+        memset(view->grid, CELL_empty,
+               view->board_nlines * view->board_ncols);
+        view->length = 0;
+        view->food = (Pose){.y = -1, .x = -1};
+    }
 
-bool snake_contains_pos(Snake *snake, Pose pos) {
-    Node *cur = snake->deq->head->next;
-    while (cur != snake->deq->tail) {
-        if (pose_equal(cur->data, pos)) {
-            return true;
-        }
-        cur = cur->next;
+    int old_begin, new_begin;
+    int span =
+        snakeview_common_span(view, body, length, &old_begin, &new_begin);
+    // cleared first, the head may have moved onto where the tail was
+    snakeview_set_cells(view, view->body, 0, old_begin, CELL_empty);
+    snakeview_set_cells(view, view->body, old_begin + span, view->length,
+                        CELL_empty);
+    if (pose_equal(food, view->food) == false &&
+        snakeview_cell(view, view->food) == CELL_food) {
+        snakeview_set_cell(view, view->food, CELL_empty);
     }
-    return false;
+    snakeview_set_cells(view, body, 0, new_begin, CELL_snake);
+    snakeview_set_cells(view, body, new_begin + span, length, CELL_snake);
+    // the food cell is covered by the head on a win
+    if (snakeview_cell(view, food) != CELL_snake) {
+        snakeview_set_cell(view, food, CELL_food);
+    }
+
+    memcpy(view->body, body, length * sizeof *body);
+    view->length = length;
+    view->food = food;
 }
 
-void snake_update(Snake *snake) {
-    if (snake->state != STATE_active) {
-        fprintf(stderr, "not active\n");
-        return;
-    }
+enum FIELD {
+    FIELD_score,
+    FIELD_speed,
+    FIELD_continues,
+    FIELD_time,
+    FIELD_count,
+};
+
+typedef struct InfoView {
+    Renderer *renderer;
+    // screen position of the first row inside the border
+    int begin_y;
+    int begin_x;
+    int ncols;
+    // each field's column relative to begin_x and its width
+    int field_x[FIELD_count];
+    int field_ncols[FIELD_count];
+
+    // what each field shows now, -1 before the first update
+    int score;
+    int max_score;
+    int score_ndigs;
+    long speed_centi;
+    int continues;
+    int time_sec;
+} InfoView;
+
+// draws the border and rewrites every field on the next update
+void infoview_repaint(InfoView *info) {
+    Renderer *renderer = info->renderer;
+    int border_y = info->begin_y - 1;
+    int border_x = info->begin_x - 1;
+
+    renderer_box(renderer, border_y, border_x, 1 + 2, info->ncols + 2,
+                 PAIR_BORDER);
 
-    Pose next_pos = deque_get_head(snake->deq)->data;
-    if (snake->flipped == true) {
-        next_pos = deque_get_tail(snake->deq)->data;
+    for (int i = FIELD_speed; i < FIELD_count; i++) {
+        int x = info->begin_x + info->field_x[i] - 2;
+        renderer_put(renderer, border_y, x, RENDERER_TTEE, PAIR_BORDER);
+        renderer_put(renderer, border_y + 1, x, RENDERER_VLINE, PAIR_BORDER);
+        renderer_put(renderer, border_y + 2, x, RENDERER_BTEE, PAIR_BORDER);
     }
 
-    switch (snake->dir) {
-    case DIRECTION_left:
-        next_pos.x--;
-        break;
-    case DIRECTION_right:
-        next_pos.x++;
-        break;
-    case DIRECTION_up:
-        next_pos.y--;
-        break;
-    case DIRECTION_down:
-        next_pos.y++;
-        break;
-    default:
-        fprintf(stderr, "null direction\n");
-        return;
+    info->score = -1;
+    info->max_score = -1;
+    info->score_ndigs = 0;
+    info->speed_centi = -1;
+    info->continues = -1;
+    info->time_sec = -1;
+}
+
+InfoView *infoview_new(Renderer *renderer, int score_ncols, int speed_ncols,
+                       int continues_ncols, int time_ncols, int begin_y,
+                       int begin_x) {
+    InfoView *info = malloc(sizeof *info);
+
+    info->renderer = renderer;
+    info->begin_y = begin_y;
+    info->begin_x = begin_x;
+    info->ncols =
+        score_ncols + speed_ncols + continues_ncols + time_ncols + 3 * 3 + 2;
+
+    info->field_x[FIELD_score] = 1;
+    info->field_x[FIELD_speed] = 1 + 3 + score_ncols;
+    info->field_x[FIELD_continues] = 1 + 2 * 3 + score_ncols + speed_ncols;
+    info->field_x[FIELD_time] =
+        1 + 3 * 3 + score_ncols + speed_ncols + continues_ncols;
+    info->field_ncols[FIELD_score] = score_ncols;
+    info->field_ncols[FIELD_speed] = speed_ncols;
+    info->field_ncols[FIELD_continues] = continues_ncols;
+    info->field_ncols[FIELD_time] = time_ncols;
+
+    infoview_repaint(info);
+
+    return info;
+}
+
+void infoview_destroy(InfoView *info) {
+    free(info);
+}
+
+void infoview_set_field(InfoView *info, enum FIELD field, const char *text) {
+    renderer_text(info->renderer, info->begin_y,
+                  info->begin_x + info->field_x[field],
+                  info->field_ncols[field], 0, "%s", text);
+}
+
+// rewrites only the fields whose value changed
+void infoview_update_info(InfoView *info, int score, int max_score,
+                          double speed, int continues, int time_sec) {
+    char text[64];
+    if (max_score != info->max_score) {
+        info->max_score = max_score;
+        info->score_ndigs = log10(max_score) + 1;
+        info->score = -1;
+    }
+    if (score != info->score) {
+        info->score = score;
+        snprintf(text, sizeof text, "Score: %*d / %d", info->score_ndigs,
+                 score, max_score);
+        infoview_set_field(info, FIELD_score, text);
     }
 
-    if (snake_pos_out_of_bounds(snake, next_pos) ||
-        snake_contains_pos(snake, next_pos)) {
-        snake->state = STATE_lose;
-        return;
+    long speed_centi = lround(speed * 100);
+    if (speed_centi != info->speed_centi) {
+        info->speed_centi = speed_centi;
+        // fewer decimals as it grows, turbo speeds run into the thousands
+        int decimals = speed < 10 ? 2 : speed < 100 ? 1 : 0;
+        snprintf(text, sizeof text, "Speed: x%.*f", decimals, speed);
+        infoview_set_field(info, FIELD_speed, text);
     }
 
-    Node *n = node_new(next_pos);
-    if (snake->flipped == false) {
-        deque_push_front(snake->deq, n);
-    } else {
-        deque_push_back(snake->deq, n);
+    if (continues != info->continues) {
+        info->continues = continues;
+        snprintf(text, sizeof text, "Continues: %d", continues);
+        infoview_set_field(info, FIELD_continues, text);
     }
 
-    if (pose_equal(next_pos, snake->food_pos) == true) {
-        if (snake->deq->length == snake->nlines * snake->ncols) {
-            snake->state = STATE_win;
-        } else {
-            snake->food_pos = snake_find_food_pos(snake);
-        }
-    } else {
-        if (snake->flipped == false) {
-            deque_pop_back(snake->deq);
-        } else {
-            deque_pop_front(snake->deq);
-        }
+    if (time_sec != info->time_sec) {
+        info->time_sec = time_sec;
+        snprintf(text, sizeof text, "%02d:%02d", time_sec / 60,
+                 time_sec % 60);
+        infoview_set_field(info, FIELD_time, text);
     }
 }
 
-typedef struct SnakeView {
-    WINDOW *win;
-    WINDOW *border;
-} SnakeView;
+// where a frame's time goes, each stage timed on its own
+enum STAGE {
+    STAGE_input,
+    // the autopilot's choice of turn, which has to fit in a tick
+    STAGE_pilot,
+    STAGE_update,
+    // copying the state out for the render thread
+    STAGE_snapshot,
+    // draw, info and flush run on the render thread
+    STAGE_draw,
+    STAGE_info,
+    STAGE_flush,
+    STAGE_sleep,
+    STAGE_count,
+};
 
-SnakeView *snakeview_new(int nlines, int ncols, int begin_y, int begin_x) {
+#define RENDER_STAGES (STAGE_flush - STAGE_draw + 1)
 
-    SnakeView *view = malloc(sizeof *view);
-
-    view->border = newwin(nlines + 2, ncols + 2, begin_y - 1, begin_x - 1);
-    view->win = derwin(view->border, nlines, ncols, 1, 1);
+static const char *const stage_names[STAGE_count] = {
+    [STAGE_input] = "input", [STAGE_pilot] = "pilot",
+    [STAGE_update] = "update",
+    [STAGE_snapshot] = "snapshot", [STAGE_draw] = "draw",
+    [STAGE_info] = "info", [STAGE_flush] = "flush",
+    [STAGE_sleep] = "sleep",
+};
 
-    wattron(view->border, COLOR_PAIR(PAIR_BORDER));
+// per stage latency overlay, placed by screen_new off the board
+typedef struct StatsView {
+    Renderer *renderer;
+    int begin_y;
+    int begin_x;
+} StatsView;
 
-    box(view->border, 0, 0);
+StatsView *statsview_new(Renderer *renderer, int begin_y, int begin_x) {
+    StatsView *stats = malloc(sizeof *stats);
 
-    wattroff(view->border, COLOR_PAIR(PAIR_BORDER));
+    stats->renderer = renderer;
+    stats->begin_y = begin_y;
+    stats->begin_x = begin_x;
 
-    wrefresh(view->border);
+    return stats;
+}
 
-    return view;
+void statsview_destroy(StatsView *stats) {
+    free(stats);
 }
 
-void snakeview_destroy(SnakeView *view) {
-    delwin(view->win);
-    delwin(view->border);
+// the overlay's rows inside its border
+typedef char StatsLines[STATS_NLINES - 2][64];
+
+void stats_format(StatsLines lines, Histogram const *stages,
+                  double tick_rate, double nominal_rate) {
+    snprintf(lines[0], sizeof lines[0], "ticks/s %6.2f of %6.2f", tick_rate,
+             nominal_rate);
+    snprintf(lines[1], sizeof lines[1], "%-8s %7s %7s %7s", "stage", "p50",
+             "p99", "max");
+    for (int i = 0; i < STAGE_count; i++) {
+        char p50[16], p99[16], max[16];
+        histogram_format_ns(p50, sizeof p50,
+                            histogram_percentile(&stages[i], 50));
+        histogram_format_ns(p99, sizeof p99,
+                            histogram_percentile(&stages[i], 99));
+        histogram_format_ns(max, sizeof max, stages[i].max);
+        snprintf(lines[2 + i], sizeof lines[2 + i], "%-8s %7s %7s %7s",
+                 stage_names[i], p50, p99, max);
+    }
+}
 
-    free(view);
+void statsview_draw(StatsView *stats, StatsLines const lines) {
+    renderer_box(stats->renderer, stats->begin_y, stats->begin_x,
+                 STATS_NLINES, STATS_NCOLS, PAIR_BORDER);
+    for (int i = 0; i < STATS_NLINES - 2; i++) {
+        renderer_text(stats->renderer, stats->begin_y + 1 + i,
+                      stats->begin_x + 1, STATS_NCOLS - 2, 0, " %s",
+                      lines[i]);
+    }
 }
 
-void mvwaddch_four(WINDOW *win, int y, int x, const chtype ch) {
-    int y_tf = y * 2;
-    int x_tf = x * 2;
+#define HELP_NLINES 10
+#define HELP_NCOLS 30
+
+enum POPUP {
+    POPUP_none,
+    POPUP_help,
+    POPUP_lose,
+    POPUP_win,
+};
+
+// everything the screen shows, copied out of the game so it can be drawn
+// on another thread while the game goes on
+typedef struct Frame {
+    // in deque order, room for a body filling the board
+    Pose *body;
+    int length;
+    Pose food;
+    int score;
+    int max_score;
+    double speed;
+    int continues;
+    int time_sec;
+    enum POPUP popup;
+    int high_score;
+    bool stats_visible;
+    StatsLines stats_lines;
+    // bumped when the terminal is resized
+    unsigned resizes;
+} Frame;
+
+size_t frame_arena_size(int nlines, int ncols) {
+    return arena_footprint((size_t)nlines * ncols * sizeof(Pose));
+}
 
-    mvwaddch(win, y_tf, x_tf, ch);
-    mvwaddch(win, y_tf, x_tf + 1, ch);
-    mvwaddch(win, y_tf + 1, x_tf, ch);
-    mvwaddch(win, y_tf + 1, x_tf + 1, ch);
+// the body goes in arena, which must have frame_arena_size bytes left
+void frame_init(Frame *frame, Arena *arena, int nlines, int ncols) {
+    frame->body = arena_alloc(arena, (size_t)nlines * ncols * sizeof(Pose));
+    frame->length = 0;
 }
-void snakeview_redraw(SnakeView *view, Deque *deq, Pose food_pos) {
-    wclear(view->win);
 
-    wattron(view->win, COLOR_PAIR(PAIR_SNAKE));
-    Node *cur = deq->head->next;
-    while (cur != deq->tail) {
-        mvwaddch_four(view->win, cur->data.y, cur->data.x, ACS_BLOCK);
-        cur = cur->next;
+// the terminal side: views and what they showed last, used by one thread
+typedef struct Screen {
+    Renderer *renderer;
+    SnakeView *view;
+    InfoView *info;
+    StatsView *stats;
+    // a change in any of these repaints the whole screen
+    enum POPUP popup;
+    bool stats_visible;
+    unsigned resizes;
+    bool repaint;
+    // only the draw, info and flush stages are recorded here
+    Histogram stages[STAGE_count];
+} Screen;
+
+Screen *screen_new(Renderer *renderer, int nlines, int ncols,
+                   enum GLYPHS glyphs, int begin_y, int begin_x) {
+    Screen *screen = malloc(sizeof *screen);
+
+    screen->renderer = renderer;
+    screen->view =
+        snakeview_new(renderer, nlines, ncols, glyphs, begin_y, begin_x);
+
+    int max_score = nlines * ncols;
+    int score_ncols = (floor(log10(max_score)) + 1) * 2 + SCORE_CONST_NCOLS;
+    int info_ncols = score_ncols + SPEED_NCOLS + CONTINUES_NCOLS + TIME_NCOLS +
+                     3 * 3 + 2 * 2;
+    int screen_nlines, screen_ncols;
+    renderer_size(renderer, &screen_nlines, &screen_ncols);
+    screen->info =
+        infoview_new(renderer, score_ncols, SPEED_NCOLS, CONTINUES_NCOLS,
+                     TIME_NCOLS, begin_y - 3, screen_ncols - info_ncols);
+    // right of the board where it fits, else under it, and over the board's
+    // bottom left only when the terminal has no room anywhere else
+    SnakeView *view = screen->view;
+    int stats_y = view->begin_y - 1;
+    int stats_x = view->begin_x + view->ncols + 2;
+    if (stats_x + STATS_NCOLS > screen_ncols) {
+        stats_y = view->begin_y + view->nlines + 1;
+        stats_x = view->begin_x - 1;
+        if (stats_y + STATS_NLINES > screen_nlines) {
+            stats_y = screen_nlines - STATS_NLINES;
+            stats_x = 0;
+        }
     }
-    wattroff(view->win, COLOR_PAIR(PAIR_SNAKE));
-
-    // checking for win basically
-    if (deque_contains(deq, food_pos) == false) {
-        wattron(view->win, COLOR_PAIR(PAIR_FOOD));
-        mvwaddch_four(view->win, food_pos.y, food_pos.x, ACS_BLOCK);
-        wattroff(view->win, COLOR_PAIR(PAIR_FOOD));
+    screen->stats = statsview_new(renderer, stats_y, stats_x);
+
+    screen->popup = POPUP_none;
+    screen->stats_visible = false;
+    screen->resizes = 0;
+    screen->repaint = true;
+    for (int i = 0; i < STAGE_count; i++) {
+        histogram_reset(&screen->stages[i]);
     }
 
-    wrefresh(view->win);
+    return screen;
 }
 
-typedef struct InfoView {
-    WINDOW *win;
-    WINDOW *border;
-
-    WINDOW *score_win;
-    WINDOW *speed_win;
-    WINDOW *continues_win;
-    WINDOW *time_win;
-} InfoView;
-
-InfoView *infoview_new(int nlines, int score_ncols, int speed_ncols,
-                       int continues_ncols, int time_ncols, int begin_y,
-                       int begin_x) {
-    InfoView *info = malloc(sizeof *info);
+void screen_destroy(Screen *screen) {
+    snakeview_destroy(screen->view);
+    infoview_destroy(screen->info);
+    statsview_destroy(screen->stats);
+    renderer_destroy(screen->renderer);
+    free(screen);
+}
 
-    int ncols =
-        score_ncols + speed_ncols + continues_ncols + time_ncols + 3 * 3 + 2;
+int64_t screen_stage(Screen *screen, enum STAGE stage, int64_t start) {
+    int64_t now = timer_now_ns();
+    histogram_record(&screen->stages[stage], now - start);
+    return now;
+}
 
-    info->border = newwin(nlines + 2, ncols + 2, begin_y - 1, begin_x - 1);
-    info->win = derwin(info->border, nlines, ncols, 1, 1);
+// a bordered popup of nlines by ncols centered on the board, kept on screen,
+// returning where its text goes
+void screen_popup_box(Screen *screen, int nlines, int ncols, int *text_y,
+                      int *text_x) {
+    SnakeView *view = screen->view;
+    int screen_nlines, screen_ncols;
+    renderer_size(screen->renderer, &screen_nlines, &screen_ncols);
+    int y = view->begin_y + (view->nlines - nlines) / 2;
+    int x = view->begin_x + (view->ncols - ncols) / 2;
+    y = y + nlines > screen_nlines ? screen_nlines - nlines : y;
+    x = x + ncols > screen_ncols ? screen_ncols - ncols : x;
+    y = y < 0 ? 0 : y;
+    x = x < 0 ? 0 : x;
+
+    renderer_fill(screen->renderer, y, x, nlines, ncols, ' ', 0);
+    renderer_box(screen->renderer, y, x, nlines, ncols, 0);
+    *text_y = y + 1;
+    *text_x = x + 1;
+}
 
-    int midsegidx[3] = {
-        1 + 3 + score_ncols,
-        1 + 2 * 3 + score_ncols + speed_ncols,
-        1 + 3 * 3 + score_ncols + speed_ncols + continues_ncols,
+void screen_draw_popup(Screen *screen, Frame const *frame) {
+    static const char *const help[] = {
+        "           HELP",
+        " <space to flip direction>",
+        " <f to increase speed>",
+        " <s to decrease speed>",
+        " <h to show help / pause>",
+        " <p to show frame stats>",
+        " <a to toggle autopilot>",
+        " <F1 to quit>",
     };
-    info->score_win = derwin(info->win, nlines, score_ncols, 0, 1);
-    info->speed_win = derwin(info->win, nlines, speed_ncols, 0, midsegidx[0]);
-    info->continues_win =
-        derwin(info->win, nlines, continues_ncols, 0, midsegidx[1]);
-    info->time_win = derwin(info->win, nlines, time_ncols, 0, midsegidx[2]);
-
-    wattron(info->border, COLOR_PAIR(PAIR_BORDER));
+    Renderer *renderer = screen->renderer;
+    int y, x;
+
+    switch (frame->popup) {
+    case POPUP_help:
+        screen_popup_box(screen, HELP_NLINES, HELP_NCOLS, &y, &x);
+        for (size_t i = 0; i < sizeof help / sizeof help[0]; i++) {
+            renderer_text(renderer, y + i, x, HELP_NCOLS - 2, 0, "%s",
+                          help[i]);
+        }
+        break;
+    case POPUP_lose:
+        screen_popup_box(screen, END_NLINES, END_NCOLS, &y, &x);
+        renderer_text(renderer, y++, x, END_NCOLS - 2, 0, "    YOU LOSE!");
+        renderer_text(renderer, y++, x, END_NCOLS - 2, 0, " High Score: %d",
+                      frame->high_score);
+        renderer_text(renderer, y++, x, END_NCOLS - 2, 0, " <c to continue>");
+        renderer_text(renderer, y++, x, END_NCOLS - 2, 0, " <r to restart>");
+        break;
+    case POPUP_win:
+        // no continue line
+        screen_popup_box(screen, END_NLINES - 1, END_NCOLS, &y, &x);
+        renderer_text(renderer, y++, x, END_NCOLS - 2, 0, "     YOU WIN!");
+        renderer_text(renderer, y++, x, END_NCOLS - 2, 0, " High Score: %d",
+                      frame->high_score);
+        renderer_text(renderer, y++, x, END_NCOLS - 2, 0, " <r to restart>");
+        break;
+    case POPUP_none:
+        break;
+    }
+}
 
-    box(info->border, 0, 0);
+void screen_draw(Screen *screen, Frame const *frame) {
+    int64_t start = timer_now_ns();
+    if (frame->resizes != screen->resizes) {
+        renderer_resize(screen->renderer);
+        screen->resizes = frame->resizes;
+        screen->repaint = true;
+    }
+    // whatever an overlay covered has to come back when it closes
+    if (frame->popup != screen->popup ||
+        frame->stats_visible != screen->stats_visible) {
+        screen->popup = frame->popup;
+        screen->stats_visible = frame->stats_visible;
+        screen->repaint = true;
+    }
+    if (screen->repaint == true) {
+        renderer_clear(screen->renderer);
+        snakeview_draw_border(screen->view);
+        infoview_repaint(screen->info);
+    }
 
-    for (int i = 0; i < (sizeof midsegidx / sizeof midsegidx[0]); i++) {
-        mvwaddch(info->border, 0, midsegidx[i] - 1, ACS_TTEE);
-        mvwaddch(info->border, 1, midsegidx[i] - 1, ACS_VLINE);
-        mvwaddch(info->border, 2, midsegidx[i] - 1, ACS_BTEE);
+    snakeview_redraw(screen->view, frame->body, frame->length, frame->food,
+                     screen->repaint);
+    screen->repaint = false;
+    start = screen_stage(screen, STAGE_draw, start);
+    infoview_update_info(screen->info, frame->score, frame->max_score,
+                         frame->speed, frame->continues, frame->time_sec);
+    start = screen_stage(screen, STAGE_info, start);
+
+    // drawn after the board so they stay on top of it
+    if (frame->stats_visible == true) {
+        statsview_draw(screen->stats, frame->stats_lines);
     }
+    screen_draw_popup(screen, frame);
 
-    wattroff(info->border, COLOR_PAIR(PAIR_BORDER));
+    // everything drawn above reaches the terminal in one write
+    start = timer_now_ns();
+    renderer_flush(screen->renderer);
+    screen_stage(screen, STAGE_flush, start);
+}
 
-    wrefresh(info->border);
+// Draws on its own thread so a slow terminal never holds up a tick. The
+// game publishes frames through a triple buffer and the thread draws the
+// newest one whenever it is free, skipping any that came in meanwhile.
+// Only for renderers that are threadable, which ansi, the default, is;
+// curses is not thread safe and the game thread reads keys through it.
+typedef struct RenderThread {
+    Screen *screen;
+    Frame frames[3];
+    TripleBuffer frame_slots;
+    // the render stages on their way back for the overlay and stats page
+    Histogram stages[3][RENDER_STAGES];
+    TripleBuffer stage_slots;
+    int64_t next_stages_ns;
+    // an eventfd the game bumps after each frame
+    int wake_fd;
+    atomic_bool stop;
+    pthread_t thread;
+} RenderThread;
+
+void *renderthread_run(void *arg) {
+    RenderThread *render = arg;
+    uint64_t count;
+
+    while (read(render->wake_fd, &count, sizeof count) > 0 ||
+           errno == EINTR) {
+        if (atomic_load(&render->stop) == true) {
+            break;
+        }
+        if (triplebuf_acquire(&render->frame_slots) == false) {
+            continue;
+        }
+        screen_draw(render->screen,
+                    &render->frames[render->frame_slots.read]);
+
+        int64_t now = timer_now_ns();
+        if (now >= render->next_stages_ns) {
+            memcpy(render->stages[render->stage_slots.write],
+                   &render->screen->stages[STAGE_draw],
+                   sizeof render->stages[0]);
+            triplebuf_publish(&render->stage_slots);
+            render->next_stages_ns = now + PUBLISH_NS;
+        }
+    }
+    return NULL;
+}
 
-    return info;
+size_t renderthread_arena_size(int nlines, int ncols) {
+    return arena_footprint(sizeof(RenderThread)) +
+           3 * frame_arena_size(nlines, ncols);
 }
 
-void infoview_destroy(InfoView *info) {
-    delwin(info->score_win);
-    delwin(info->speed_win);
-    delwin(info->continues_win);
-    delwin(info->time_win);
+// takes over screen, living in arena, which must have
+// renderthread_arena_size bytes left; NULL if the thread could not be
+// started
+RenderThread *renderthread_new(Screen *screen, Arena *arena, int nlines,
+                               int ncols) {
+    RenderThread *render = arena_alloc(arena, sizeof *render);
+    render->screen = screen;
+    for (int i = 0; i < 3; i++) {
+        frame_init(&render->frames[i], arena, nlines, ncols);
+    }
+    triplebuf_init(&render->frame_slots);
+    triplebuf_init(&render->stage_slots);
+    render->next_stages_ns = 0;
+    atomic_init(&render->stop, false);
+    render->wake_fd = eventfd(0, EFD_CLOEXEC);
+
+    if (render->wake_fd < 0) {
+        return NULL;
+    }
+    if (pthread_create(&render->thread, NULL, renderthread_run, render) !=
+        0) {
+        close(render->wake_fd);
+        return NULL;
+    }
+    return render;
+}
 
-    delwin(info->win);
-    delwin(info->border);
+// stops the thread and hands the screen back
+Screen *renderthread_destroy(RenderThread *render) {
+    uint64_t one = 1;
+    atomic_store(&render->stop, true);
+    while (write(render->wake_fd, &one, sizeof one) < 0 && errno == EINTR) {
+    }
+    pthread_join(render->thread, NULL);
 
-    free(info);
+    close(render->wake_fd);
+    return render->screen;
 }
 
-void infoview_update_info(InfoView *info, int score, int max_score,
-                          double speed, int continues, int time_sec) {
-    int minutes = time_sec / 60;
-    int secs = time_sec % 60;
+// the slot to fill before renderthread_submit
+Frame *renderthread_frame(RenderThread *render) {
+    return &render->frames[render->frame_slots.write];
+}
 
-    int ndigs = log10(max_score) + 1;
-    mvwprintw(info->score_win, 0, 0, "Score: %*d / %d", ndigs, score,
-              max_score);
-    mvwprintw(info->speed_win, 0, 0, "Speed: x%0.2fd", speed);
-    wclear(info->continues_win);
-    mvwprintw(info->continues_win, 0, 0, "Continues: %d", continues);
-    mvwprintw(info->time_win, 0, 0, "%02d:%02d", minutes, secs);
+void renderthread_submit(RenderThread *render) {
+    uint64_t one = 1;
+    triplebuf_publish(&render->frame_slots);
+    // the counter only saturates, a full one means a wakeup is pending
+    while (write(render->wake_fd, &one, sizeof one) < 0 && errno == EINTR) {
+    }
+}
 
-    wrefresh(info->win);
+// copies the render thread's stage histograms into stages[STAGE_draw] and
+// on, if it has sent newer ones
+void renderthread_collect(RenderThread *render, Histogram *stages) {
+    if (triplebuf_acquire(&render->stage_slots) == true) {
+        memcpy(&stages[STAGE_draw], render->stages[render->stage_slots.read],
+               sizeof render->stages[0]);
+    }
 }
 
 typedef struct SnakeController {
+    // holds the controller itself, the model and the frames, everything a
+    // game needs however long it runs, so play never allocates
+    Arena arena;
     Snake *model;
-    SnakeView *view;
-    InfoView *info;
+    // drawing goes through render, or straight to screen when it is NULL
+    RenderThread *render;
+    Screen *screen;
+    Frame frame;
+    // keys are read from a window nothing draws on, so reading never
+    // refreshes the screen behind the render thread's back
+    WINDOW *input;
     int max_score;
     double delay_ms;
     int continues;
     Timer *timer;
+    Scheduler *sched;
+    EventLoop *events;
+    // snake_update calls so far, the clock replay events are stamped with
+    int64_t tick;
+    ReplayWriter *recorder;
+    bool record_failed;
+    enum POPUP popup;
+    unsigned resizes;
+    // ticks faster than the frame cap share frames; a held back frame is
+    // drawn once the frame period is up
+    int64_t frame_period_ns;
+    int64_t last_frame_ns;
+    bool frame_pending;
+    bool stats_visible;
+    int64_t stats_next_update_ns;
+    StatsLines stats_lines;
+    Histogram stages[STAGE_count];
+    // NULL when shared memory is unavailable
+    StatsPage *page;
+    int64_t next_publish_ns;
+
+    enum DIRECTION dir_queue[DIR_QUEUE_LEN];
+    int dir_queue_front;
+    int dir_queue_length;
+    // steers in place of the keys while autopilot is set, NULL if there
+    // is none; its state is made up front so steering never allocates
+    Policy const *pilot;
+    void *pilot_state;
+    bool autopilot;
 
     int high_score;
 } SnakeController;
 
-SnakeController *snakecontroller_new(int nlines, int ncols, int begin_y,
-                                     int begin_x) {
-    SnakeController *controller = malloc(sizeof *controller);
-    controller->model = snake_new(nlines, ncols);
-    controller->view = snakeview_new(nlines * 2, ncols * 2, begin_y, begin_x);
+// takes over screen, drawing it from a render thread if threaded is set;
+// NULL if either could not be set up, leaving screen to the caller
+SnakeController *snakecontroller_new(Screen *screen, bool threaded,
+                                     int nlines, int ncols, uint64_t seed) {
+    size_t size = arena_footprint(sizeof(SnakeController)) +
+                  snake_arena_size(nlines, ncols) +
+                  frame_arena_size(nlines, ncols);
+    if (threaded) {
+        size += renderthread_arena_size(nlines, ncols);
+    }
+    Arena arena;
+    if (arena_init(&arena, size) == false) {
+        return NULL;
+    }
+    SnakeController *controller = arena_alloc(&arena, sizeof *controller);
+    controller->model = snake_new_in(&arena, nlines, ncols, seed);
+    frame_init(&controller->frame, &arena, nlines, ncols);
+    controller->screen = screen;
+    // blocks SIGWINCH, which the render thread has to inherit
+    controller->events = eventloop_new(STDIN_FILENO);
+    controller->delay_ms = INIT_DELAY_MS;
+    controller->timer = timer_new();
+    controller->sched =
+        scheduler_new(controller->delay_ms * NS_PER_MS, MAX_CATCH_UP);
+    if (controller->sched != NULL) {
+        scheduler_set_batch_window(controller->sched, TICK_BATCH_NS);
+    }
+    // set up before the render thread starts, it draws nothing with curses
+    controller->input = newwin(1, 1, 0, 0);
+    keypad(controller->input, TRUE);
+    nodelay(controller->input, TRUE);
+    // a fresh window counts as changed, which the first read would refresh
+    wnoutrefresh(controller->input);
+    controller->render = NULL;
+    if (threaded && controller->events != NULL) {
+        controller->render =
+            renderthread_new(screen, &arena, nlines, ncols);
+    }
+    if (controller->events == NULL || controller->timer == NULL ||
+        controller->sched == NULL ||
+        (threaded && controller->render == NULL)) {
+        if (controller->render != NULL) {
+            renderthread_destroy(controller->render);
+        }
+        delwin(controller->input);
+        if (controller->events != NULL) {
+            eventloop_destroy(controller->events);
+        }
+        if (controller->timer != NULL) {
+            timer_destroy(controller->timer);
+        }
+        if (controller->sched != NULL) {
+            scheduler_destroy(controller->sched);
+        }
+        arena_release(&arena);
+        return NULL;
+    }
+    controller->pilot = NULL;
+    controller->pilot_state = NULL;
+    controller->autopilot = false;
+    controller->arena = arena;
 
     controller->max_score =
         controller->model->nlines * controller->model->ncols;
-    int score_ncols =
-        (floor(log10(controller->max_score)) + 1) * 2 + SCORE_CONST_NCOLS;
-    int info_ncols = score_ncols + SPEED_NCOLS + CONTINUES_NCOLS + TIME_NCOLS +
-                     3 * 3 + 2 * 2;
-    controller->info =
-        infoview_new(1, score_ncols, SPEED_NCOLS, CONTINUES_NCOLS, TIME_NCOLS,
-                     begin_y - 3, COLS - info_ncols);
-    controller->delay_ms = INIT_DELAY_MS;
     controller->continues = 0;
-    controller->timer = timer_new();
+    controller->tick = 0;
+    controller->recorder = NULL;
+    controller->record_failed = false;
+    controller->popup = POPUP_none;
+    controller->resizes = 0;
+    controller->frame_period_ns = NS_PER_SEC / DEFAULT_FPS;
+    controller->last_frame_ns = 0;
+    controller->frame_pending = false;
+    controller->stats_visible = false;
+    controller->stats_next_update_ns = 0;
+    memset(controller->stats_lines, 0, sizeof controller->stats_lines);
+    for (int i = 0; i < STAGE_count; i++) {
+        histogram_reset(&controller->stages[i]);
+    }
+    controller->page = statspage_create();
+    controller->next_publish_ns = 0;
+    if (controller->page != NULL) {
+        StatsSnapshot *snapshot = statspage_begin(controller->page);
+        snapshot->max_score = controller->max_score;
+        snapshot->nstages = STAGE_count;
+        for (int i = 0; i < STAGE_count; i++) {
+            snprintf(snapshot->stage_names[i], STATSPAGE_NAME_LEN, "%s",
+                     stage_names[i]);
+        }
+        statspage_end(controller->page);
+    }
+    controller->dir_queue_front = 0;
+    controller->dir_queue_length = 0;
 
     controller->high_score = 0;
 
@@ -450,76 +1027,399 @@ SnakeController *snakecontroller_new(int nlines, int ncols, int begin_y,
 }
 
 void snakecontroller_destroy(SnakeController *controller) {
-    snake_destroy(controller->model);
-    snakeview_destroy(controller->view);
-    infoview_destroy(controller->info);
-    free(controller);
+    if (controller->render != NULL) {
+        renderthread_destroy(controller->render);
+    }
+    screen_destroy(controller->screen);
+    delwin(controller->input);
+    if (controller->page != NULL) {
+        statspage_destroy(controller->page);
+    }
+    timer_destroy(controller->timer);
+    scheduler_destroy(controller->sched);
+    eventloop_destroy(controller->events);
+    if (controller->pilot != NULL) {
+        controller->pilot->destroy(controller->pilot_state);
+    }
+    // the controller is in its own arena
+    Arena arena = controller->arena;
+    arena_release(&arena);
 }
 
-void snake_controller_redraw(SnakeController *controller) {
-    snakeview_redraw(controller->view, controller->model->deq,
-                     controller->model->food_pos);
-    infoview_update_info(
-        controller->info, controller->model->deq->length, controller->max_score,
-        INIT_DELAY_MS / controller->delay_ms, controller->continues,
-        timer_get_time(controller->timer));
+bool snakecontroller_record_to(SnakeController *controller, const char *path,
+                               uint64_t seed, uint32_t keyframe_interval) {
+    ReplayHeader header = {
+        .nlines = controller->model->nlines,
+        .ncols = controller->model->ncols,
+        .seed = seed,
+        .delay_us = controller->delay_ms * 1000,
+        .keyframe_interval = keyframe_interval,
+    };
+    controller->recorder = replay_writer_open(path, &header);
+    return controller->recorder != NULL;
 }
 
-void snakecontroller_end_loop(SnakeController *controller) {
-    int maxy, maxx;
-    getmaxyx(controller->view->win, maxy, maxx);
+// keep playing, the replay is reported as broken on exit
+void snakecontroller_record_failed(SnakeController *controller) {
+    replay_writer_close(controller->recorder);
+    controller->recorder = NULL;
+    controller->record_failed = true;
+}
+
+void snakecontroller_record(SnakeController *controller,
+                            enum REPLAY_EVENT type, uint32_t arg) {
+    if (controller->recorder != NULL &&
+        replay_writer_event(controller->recorder, controller->tick, type,
+                            arg) == false) {
+        snakecontroller_record_failed(controller);
+    }
+}
+
+void snakecontroller_record_tick(SnakeController *controller) {
+    if (controller->recorder != NULL &&
+        replay_writer_tick(controller->recorder, controller->tick,
+                           controller->model) == false) {
+        snakecontroller_record_failed(controller);
+    }
+}
+
+// tears down curses and the game, reporting any ticks that ran late
+void snakecontroller_quit(SnakeController *controller) {
+    SchedulerStats stats = scheduler_stats(controller->sched);
+    if (controller->recorder != NULL) {
+        snakecontroller_record(controller, REPLAY_EVENT_quit, 0);
+    }
+    if (controller->recorder != NULL &&
+        replay_writer_close(controller->recorder) == false) {
+        controller->record_failed = true;
+    }
+    bool record_failed = controller->record_failed;
+    snakecontroller_destroy(controller);
+    endwin();
+
+    if (record_failed) {
+        fprintf(stderr, "could not write the replay\n");
+    }
+
+    if (stats.late_ticks > 0 || stats.skipped_ticks > 0) {
+        fprintf(stderr,
+                "%lld ticks, %lld late, %lld skipped, worst %.1f ms behind\n",
+                (long long)stats.ticks, (long long)stats.late_ticks,
+                (long long)stats.skipped_ticks,
+                (double)stats.max_lateness_ns / NS_PER_MS);
+    }
+}
+
+// measured rather than nominal, so it drops when ticks run late
+double snakecontroller_speed(SnakeController *controller) {
+    return scheduler_tick_rate(controller->sched) * INIT_DELAY_MS / 1000;
+}
+
+// records the time since start against stage, returning now
+int64_t snakecontroller_stage(SnakeController *controller, enum STAGE stage,
+                              int64_t start) {
+    int64_t now = timer_now_ns();
+    histogram_record(&controller->stages[stage], now - start);
+    return now;
+}
+
+// brings the draw, info and flush stages over from whoever draws
+void snakecontroller_collect(SnakeController *controller) {
+    if (controller->render != NULL) {
+        renderthread_collect(controller->render, controller->stages);
+    } else {
+        memcpy(&controller->stages[STAGE_draw],
+               &controller->screen->stages[STAGE_draw],
+               RENDER_STAGES * sizeof controller->stages[0]);
+    }
+}
+
+// counters go out on every call, the bulkier histograms at most every
+// PUBLISH_NS; never blocks, whoever is reading
+void snakecontroller_publish(SnakeController *controller) {
+    if (controller->page == NULL) {
+        return;
+    }
+    int64_t now = timer_now_ns();
+    AllocCount allocs = alloccount_get();
+
+    StatsSnapshot *snapshot = statspage_begin(controller->page);
+    snapshot->tick = controller->tick;
+    snapshot->score = controller->model->deq->length;
+    snapshot->delay_ms = controller->delay_ms;
+    snapshot->continues = controller->continues;
+    snapshot->allocs = allocs.allocs;
+    snapshot->frees = allocs.frees;
+    snapshot->alloc_bytes = allocs.bytes;
+    if (now >= controller->next_publish_ns) {
+        snakecontroller_collect(controller);
+        memcpy(snapshot->stages, controller->stages,
+               sizeof controller->stages);
+        controller->next_publish_ns = now + PUBLISH_NS;
+    }
+    statspage_end(controller->page);
+}
+
+// copies what the screen shows out of the game and draws it, on the render
+// thread when there is one; the game never waits for the terminal then
+void snakecontroller_present(SnakeController *controller) {
+    int64_t start = timer_now_ns();
+    Frame *frame = controller->render != NULL
+                       ? renderthread_frame(controller->render)
+                       : &controller->frame;
+    Snake *model = controller->model;
+    Deque const *deq = model->deq;
+
+    // the body may wrap around the end of the ring
+    int first = deq->capacity - deq->front;
+    first = first < deq->length ? first : deq->length;
+    memcpy(frame->body, &deq->data[deq->front], first * sizeof *frame->body);
+    memcpy(frame->body + first, deq->data,
+           (deq->length - first) * sizeof *frame->body);
+    frame->length = deq->length;
+    frame->food = model->food_pos;
+    frame->score = deq->length;
+    frame->max_score = controller->max_score;
+    frame->speed = snakecontroller_speed(controller);
+    frame->continues = controller->continues;
+    frame->time_sec = timer_get_time(controller->timer);
+    frame->popup = controller->popup;
+    frame->high_score = controller->high_score;
+    frame->stats_visible = controller->stats_visible;
+    if (controller->stats_visible == true) {
+        // percentiles walk every bucket, a few times a second is plenty
+        if (start >= controller->stats_next_update_ns) {
+            snakecontroller_collect(controller);
+            stats_format(controller->stats_lines, controller->stages,
+                         scheduler_tick_rate(controller->sched),
+                         1000 / controller->delay_ms);
+            controller->stats_next_update_ns = start + STATS_UPDATE_NS;
+        }
+        memcpy(frame->stats_lines, controller->stats_lines,
+               sizeof frame->stats_lines);
+    }
+    frame->resizes = controller->resizes;
+    // the view diffs whole frames, the model's change list is not needed
+    snake_clear_dirty(model);
+    controller->last_frame_ns = start;
+    controller->frame_pending = false;
+    snakecontroller_stage(controller, STAGE_snapshot, start);
+
+    if (controller->render != NULL) {
+        renderthread_submit(controller->render);
+    } else {
+        screen_draw(controller->screen, frame);
+    }
+}
+
+// presents at most once per frame period, holding the frame back otherwise
+void snakecontroller_present_capped(SnakeController *controller) {
+    if (timer_now_ns() - controller->last_frame_ns <
+        controller->frame_period_ns) {
+        controller->frame_pending = true;
+        return;
+    }
+    snakecontroller_present(controller);
+}
+
+void snakecontroller_set_fps(SnakeController *controller, double fps) {
+    controller->frame_period_ns = NS_PER_SEC / fps;
+}
+
+// when the loop should wake without input: the next tick while ticking, but
+// no sooner than TICK_BATCH_NS after last_wake, or the held back frame if
+// that comes first; 0 for never
+int64_t snakecontroller_next_wakeup(SnakeController *controller,
+                                    bool ticking, int64_t last_wake) {
+    int64_t wakeup = 0;
+    if (ticking) {
+        wakeup = scheduler_next_deadline(controller->sched);
+        if (wakeup < last_wake + TICK_BATCH_NS) {
+            wakeup = last_wake + TICK_BATCH_NS;
+        }
+    }
+    int64_t frame = controller->last_frame_ns + controller->frame_period_ns;
+    if (controller->frame_pending && (wakeup == 0 || frame < wakeup)) {
+        wakeup = frame;
+    }
+    return wakeup;
+}
+
+// a pilot that searches gets half of each tick, the rest is for drawing
+static void snakecontroller_budget_pilot(SnakeController *controller) {
+    if (controller->pilot != NULL && controller->pilot->set_budget != NULL) {
+        controller->pilot->set_budget(controller->pilot_state,
+                                      controller->delay_ms * NS_PER_MS / 2);
+    }
+}
+
+void snakecontroller_set_delay(SnakeController *controller, double delay_ms) {
+    controller->delay_ms = delay_ms;
+    scheduler_set_period(controller->sched, delay_ms * NS_PER_MS);
+    snakecontroller_budget_pilot(controller);
+    snakecontroller_record(controller, REPLAY_EVENT_delay, delay_ms * 1000);
+}
+
+// repaints the whole screen after the terminal was resized
+void snakecontroller_resized(SnakeController *controller) {
+    controller->resizes++;
+    snakecontroller_present(controller);
+}
+
+void snakecontroller_toggle_stats(SnakeController *controller) {
+    controller->stats_visible = !controller->stats_visible;
+    controller->stats_next_update_ns = 0;
+    snakecontroller_present(controller);
+}
+
+// blocks without spinning until a key arrives, for the help and end screens;
+// ERR once deadline_ns passes, 0 waits for good
+int snakecontroller_wait_key(SnakeController *controller,
+                             int64_t deadline_ns) {
+    int ch;
+    eventloop_arm(controller->events, deadline_ns);
+    while ((ch = wgetch(controller->input)) == ERR) {
+        int events = eventloop_wait(controller->events);
+        if (events & EVENT_resize) {
+            snakecontroller_resized(controller);
+        }
+        if (events & EVENT_tick) {
+            return ERR;
+        }
+    }
+    return ch;
+}
+
+void snakecontroller_queue_direction(SnakeController *controller,
+                                     enum DIRECTION dir) {
+    // the first key of a game starts the snake at once
+    if (controller->model->state != STATE_active) {
+        snake_set_direction(controller->model, dir);
+        snakecontroller_record(controller, (enum REPLAY_EVENT)dir, 0);
+        return;
+    }
+
+    int length = controller->dir_queue_length;
+    if (length == DIR_QUEUE_LEN) {
+        return;
+    }
+    int last = (controller->dir_queue_front + length - 1) % DIR_QUEUE_LEN;
+    if (length > 0 && controller->dir_queue[last] == dir) {
+        return;
+    }
+    controller->dir_queue[(controller->dir_queue_front + length) %
+                          DIR_QUEUE_LEN] = dir;
+    controller->dir_queue_length++;
+}
+
+// false if the policy cannot play this board
+bool snakecontroller_set_pilot(SnakeController *controller,
+                               Policy const *pilot, uint64_t seed) {
+    void *state = pilot->create(controller->model->nlines,
+                                controller->model->ncols, seed);
+    if (state == NULL) {
+        return false;
+    }
+    if (controller->pilot != NULL) {
+        controller->pilot->destroy(controller->pilot_state);
+    }
+    controller->pilot = pilot;
+    controller->pilot_state = state;
+    snakecontroller_budget_pilot(controller);
+    return true;
+}
+
+// true if the policy can play a board this size
+static bool pilot_fits(Policy const *pilot, int nlines, int ncols) {
+    void *state = pilot->create(nlines, ncols, 0);
+    if (state == NULL) {
+        return false;
+    }
+    pilot->destroy(state);
+    return true;
+}
 
-    int y = END_NLINES;
-    int x = END_NCOLS;
+// the pilot forgets its plan, which may be for a board that is gone
+void snakecontroller_set_autopilot(SnakeController *controller, bool on) {
+    if (controller->pilot == NULL) {
+        return;
+    }
+    controller->autopilot = on;
+    controller->dir_queue_length = 0;
+    controller->pilot->reset(controller->pilot_state, controller->tick);
+}
 
-    // don't need continue line
-    if (controller->model->state == STATE_win) {
-        y--;
+// the pilot's turn for this tick, recorded like a key so replays follow it;
+// also starts a game that is waiting for its first move
+void snakecontroller_pilot(SnakeController *controller) {
+    Snake *model = controller->model;
+    int64_t start = timer_now_ns();
+    enum DIRECTION dir =
+        controller->pilot->choose(controller->pilot_state, model);
+    snakecontroller_stage(controller, STAGE_pilot, start);
+    if (dir != model->dir || model->state != STATE_active) {
+        snake_set_direction(model, dir);
+        snakecontroller_record(controller, (enum REPLAY_EVENT)dir, 0);
     }
+}
 
-    WINDOW *end_border =
-        derwin(controller->view->win, y, x, (maxy - y) / 2, (maxx - x) / 2);
-    WINDOW *end_win = derwin(end_border, y - 2, x - 2, 1, 1);
+// one queued turn per tick, so two quick turns cannot reverse the snake
+void snakecontroller_apply_direction(SnakeController *controller) {
+    if (controller->dir_queue_length == 0) {
+        return;
+    }
+    enum DIRECTION dir = controller->dir_queue[controller->dir_queue_front];
+    snake_set_direction(controller->model, dir);
+    snakecontroller_record(controller, (enum REPLAY_EVENT)dir, 0);
+    controller->dir_queue_front =
+        (controller->dir_queue_front + 1) % DIR_QUEUE_LEN;
+    controller->dir_queue_length--;
+}
 
+void snakecontroller_end_loop(SnakeController *controller) {
     timer_pause(controller->timer);
+    // a finished game is worth keeping even if the process dies later
+    if (controller->recorder != NULL) {
+        replay_writer_flush(controller->recorder);
+    }
     int score = controller->model->deq->length;
     controller->high_score =
         score > controller->high_score ? score : controller->high_score;
 
-    if (controller->model->state == STATE_lose) {
-        wprintw(end_win, "    YOU LOSE!\n");
-        wprintw(end_win, " High Score: %d\n", controller->high_score);
-        wprintw(end_win, " <c to continue>\n");
-    } else if (controller->model->state == STATE_win) {
-        wprintw(end_win, "     YOU WIN!\n");
-        wprintw(end_win, " High Score: %d\n", controller->high_score);
-    } else {
-        fprintf(stderr, "invalid end state\n");
-    }
-    wprintw(end_win, " <r to restart>\n");
-    box(end_border, 0, 0);
-    wrefresh(end_border);
+    controller->popup =
+        controller->model->state == STATE_win ? POPUP_win : POPUP_lose;
+    snakecontroller_present(controller);
 
+    // the autopilot plays on by itself, game after game
+    int64_t deadline =
+        controller->autopilot ? timer_now_ns() + AUTOPILOT_RESTART_NS : 0;
     int ch;
-    int nlines = controller->model->nlines;
-    int ncols = controller->model->ncols;
-    while ((ch = getch()) != KEY_F(1)) {
+    while ((ch = snakecontroller_wait_key(controller, deadline)) != KEY_F(1)) {
         switch (ch) {
+        case ERR:
         case 'r':
-            snake_destroy(controller->model);
-            controller->model = snake_new(nlines, ncols);
-            controller->delay_ms = INIT_DELAY_MS;
+            // the next game's seed comes from this one's stream
+            snake_reset(controller->model,
+                        rng_next(&controller->model->rng));
+            snakecontroller_record(controller, REPLAY_EVENT_restart, 0);
+            // a soak keeps the speed it was given; the restart put the
+            // replay back on the header's delay, so either way it is
+            // recorded again
+            snakecontroller_set_delay(
+                controller, ch == 'r' ? INIT_DELAY_MS : controller->delay_ms);
             controller->continues = 0;
+            snakecontroller_set_autopilot(controller, controller->autopilot);
             timer_restart(controller->timer);
-            delwin(end_win);
-            delwin(end_border);
+            controller->popup = POPUP_none;
             return;
         case 'c':
             if (controller->model->state == STATE_lose) {
                 controller->continues += 1;
                 controller->model->state = STATE_null;
-                delwin(end_win);
-                delwin(end_border);
+                snakecontroller_record(controller, REPLAY_EVENT_continue, 0);
+                snakecontroller_set_autopilot(controller,
+                                              controller->autopilot);
+                controller->popup = POPUP_none;
                 return;
             }
         default:
@@ -527,124 +1427,469 @@ void snakecontroller_end_loop(SnakeController *controller) {
         }
     }
 
-    delwin(end_win);
-    delwin(end_border);
-    snakecontroller_destroy(controller);
-    endwin();
+    snakecontroller_quit(controller);
     exit(0);
 }
 
-#define HELP_NLINES 8
-#define HELP_NCOLS 30
-
 void snakecontroller_help_loop(SnakeController *controller) {
-    int maxy, maxx;
-    getmaxyx(controller->view->win, maxy, maxx);
-
-    int y = HELP_NLINES;
-    int x = HELP_NCOLS;
-
-    WINDOW *help_border =
-        derwin(controller->view->win, y, x, (maxy - y) / 2, (maxx - x) / 2);
-    WINDOW *help_win = derwin(help_border, y - 2, x - 2, 1, 1);
-
-    if (timer_paused(controller->timer) == false) {
+    bool running = timer_paused(controller->timer) == false;
+    if (running) {
         timer_pause(controller->timer);
     }
-
-    wprintw(help_win, "           HELP\n");
-
-    wprintw(help_win, " <space to flip direction>\n");
-    wprintw(help_win, " <f to increase speed>\n");
-    wprintw(help_win, " <s to decrease speed>\n");
-    wprintw(help_win, " <h to show help / pause>\n");
-    wprintw(help_win, " <F1 to quit>\n");
-    box(help_border, 0, 0);
-    wrefresh(help_border);
+    controller->popup = POPUP_help;
+    snakecontroller_present(controller);
 
     int ch;
-    while ((ch = getch()) != KEY_F(1)) {
+    while ((ch = snakecontroller_wait_key(controller, 0)) != KEY_F(1)) {
         switch (ch) {
         case 'h':
-            delwin(help_win);
-            delwin(help_border);
-            snake_controller_redraw(controller);
+            // the game picks up where it was, without a burst of catch up
+            if (running) {
+                timer_unpause(controller->timer);
+                scheduler_reset(controller->sched);
+            }
+            controller->popup = POPUP_none;
+            snakecontroller_present(controller);
             return;
         default:
             break;
         }
     }
 
-    delwin(help_win);
-    delwin(help_border);
-    snakecontroller_destroy(controller);
-    endwin();
+    snakecontroller_quit(controller);
     exit(0);
 }
 
+void snakecontroller_handle_key(SnakeController *controller, int ch) {
+    // steering by hand takes over from the autopilot
+    if (controller->autopilot &&
+        (ch == KEY_LEFT || ch == KEY_RIGHT || ch == KEY_UP || ch == KEY_DOWN)) {
+        snakecontroller_set_autopilot(controller, false);
+    }
+    switch (ch) {
+    case KEY_LEFT:
+        snakecontroller_queue_direction(controller, DIRECTION_left);
+        break;
+    case KEY_RIGHT:
+        snakecontroller_queue_direction(controller, DIRECTION_right);
+        break;
+    case KEY_UP:
+        snakecontroller_queue_direction(controller, DIRECTION_up);
+        break;
+    case KEY_DOWN:
+        snakecontroller_queue_direction(controller, DIRECTION_down);
+        break;
+    case ' ':
+        // queued turns were meant for the old head
+        controller->dir_queue_length = 0;
+        snake_flip(controller->model);
+        snakecontroller_record(controller, REPLAY_EVENT_flip, 0);
+        break;
+    case 'f':
+        if (controller->delay_ms / 1.5 >= MIN_DELAY_MS) {
+            snakecontroller_set_delay(controller, controller->delay_ms / 1.5);
+        }
+        break;
+    case 's':
+        snakecontroller_set_delay(controller, controller->delay_ms * 1.5);
+        break;
+    case 'h':
+        snakecontroller_help_loop(controller);
+        break;
+    case 'p':
+        snakecontroller_toggle_stats(controller);
+        break;
+    case 'a':
+        snakecontroller_set_autopilot(controller, !controller->autopilot);
+        break;
+    default:
+        break;
+    }
+}
+
 void snakecontroller_loop(SnakeController *controller) {
     timer_start(controller->timer);
-    snakeview_redraw(controller->view, controller->model->deq,
-                     controller->model->food_pos);
+    snakecontroller_present(controller);
 
-    infoview_update_info(
-        controller->info, controller->model->deq->length, controller->max_score,
-        INIT_DELAY_MS / controller->delay_ms, controller->continues,
-        timer_get_time(controller->timer));
-    int ch;
-    timeout(0);
-    while ((ch = getch()) != KEY_F(1)) {
-        switch (ch) {
-        case KEY_LEFT:
-            snake_set_direction(controller->model, DIRECTION_left);
-            break;
-        case KEY_RIGHT:
-            snake_set_direction(controller->model, DIRECTION_right);
-            break;
-        case KEY_UP:
-            snake_set_direction(controller->model, DIRECTION_up);
-            break;
-        case KEY_DOWN:
-            snake_set_direction(controller->model, DIRECTION_down);
-            break;
-        case ' ':
-            snake_flip(controller->model);
-            break;
-        case 'f':
-            controller->delay_ms /= 1.5;
-            break;
-        case 's':
-            controller->delay_ms *= 1.5;
-            break;
-        case 'h':
-            snakecontroller_help_loop(controller);
-            break;
-        default:
-            break;
+    bool was_active = false;
+    int64_t start = timer_now_ns();
+    while (true) {
+        if (controller->autopilot && controller->model->state == STATE_null) {
+            snakecontroller_pilot(controller);
         }
+        eventloop_arm(controller->events,
+                      snakecontroller_next_wakeup(
+                          controller,
+                          controller->model->state == STATE_active, start));
+        start = timer_now_ns();
+        int events = eventloop_wait(controller->events);
+        // waiting for the first key is not part of any frame
         if (controller->model->state == STATE_active) {
-            if (timer_paused(controller->timer) == true) {
-                timer_unpause(controller->timer);
+            start = snakecontroller_stage(controller, STAGE_sleep, start);
+        } else {
+            start = timer_now_ns();
+        }
+
+        if (events & EVENT_resize) {
+            snakecontroller_resized(controller);
+        }
+        if (events & EVENT_input) {
+            int ch;
+            while ((ch = wgetch(controller->input)) != ERR) {
+                if (ch == KEY_F(1)) {
+                    return;
+                }
+                snakecontroller_handle_key(controller, ch);
+                // the help screen waits on the player, not on us
+                if (ch == 'h') {
+                    start = timer_now_ns();
+                } else {
+                    start = snakecontroller_stage(controller, STAGE_input,
+                                                  start);
+                }
+            }
+        }
+
+        if (controller->model->state == STATE_active) {
+            // ticks are phased from the first move, not from when the
+            // snake stopped
+            if (was_active == false) {
+                if (timer_paused(controller->timer) == true) {
+                    timer_unpause(controller->timer);
+                }
+                scheduler_reset(controller->sched);
+            }
+            int steps = scheduler_poll(controller->sched, timer_now_ns());
+            int ran = 0;
+            while (ran < steps && controller->model->state == STATE_active) {
+                if (controller->autopilot) {
+                    snakecontroller_pilot(controller);
+                }
+                start = timer_now_ns();
+                snakecontroller_apply_direction(controller);
+                snake_update(controller->model);
+                controller->tick++;
+                snakecontroller_record_tick(controller);
+                snakecontroller_stage(controller, STAGE_update, start);
+                ran++;
+            }
+            scheduler_ran(controller->sched, ran, timer_now_ns());
+            if (ran > 0 || controller->frame_pending) {
+                snakecontroller_present_capped(controller);
+            }
+        } else {
+            if (timer_paused(controller->timer) == false) {
+                timer_pause(controller->timer);
             }
-            snake_update(controller->model);
-            snake_controller_redraw(controller);
-        } else if (timer_paused(controller->timer) == false) {
-            timer_pause(controller->timer);
         }
 
         if (controller->model->state == STATE_win ||
             controller->model->state == STATE_lose) {
             snakecontroller_end_loop(controller);
-            snake_controller_redraw(controller);
+            snakecontroller_present(controller);
+        }
+        snakecontroller_publish(controller);
+        was_active = controller->model->state == STATE_active;
+    }
+}
+
+void snakecontroller_replay_loop(SnakeController *controller,
+                                 ReplayPlayer *player, double speed) {
+    timer_start(controller->timer);
+    snakecontroller_set_delay(controller, player->delay_us / 1000.0 / speed);
+    snakecontroller_present(controller);
+
+    // once the recording is over the last frame stays up for seeking
+    bool playing = true;
+    int64_t start = timer_now_ns();
+    while (true) {
+        eventloop_arm(controller->events,
+                      snakecontroller_next_wakeup(controller, playing, start));
+        start = timer_now_ns();
+        int events = eventloop_wait(controller->events);
+        if (playing) {
+            snakecontroller_stage(controller, STAGE_sleep, start);
+        }
+
+        if (events & EVENT_resize) {
+            snakecontroller_resized(controller);
+        }
+        if (events & EVENT_input) {
+            int ch;
+            while ((ch = wgetch(controller->input)) != ERR) {
+                if (ch == KEY_F(1)) {
+                    return;
+                } else if (ch == 'p') {
+                    snakecontroller_toggle_stats(controller);
+                } else if (ch == 'f') {
+                    speed *= 1.5;
+                } else if (ch == 's') {
+                    speed /= 1.5;
+                } else if (ch == '[' || ch == ']') {
+                    int64_t tick = player->tick + (ch == '[' ? -SEEK_TICKS
+                                                             : SEEK_TICKS);
+                    playing = replay_player_seek(player, tick < 0 ? 0 : tick);
+                    scheduler_reset(controller->sched);
+                    snakecontroller_present(controller);
+                }
+            }
+        }
+
+        int ran = 0;
+        if (playing) {
+            int steps = scheduler_poll(controller->sched, timer_now_ns());
+            while (ran < steps) {
+                start = timer_now_ns();
+                playing = replay_player_step(player);
+                if (playing == false) {
+                    break;
+                }
+                snakecontroller_stage(controller, STAGE_update, start);
+                ran++;
+            }
+            scheduler_ran(controller->sched, ran, timer_now_ns());
+        }
+
+        controller->continues = player->continues;
+        controller->tick = player->tick;
+        double delay_ms = player->delay_us / 1000.0 / speed;
+        if (delay_ms != controller->delay_ms) {
+            snakecontroller_set_delay(controller, delay_ms);
+        }
+        if (ran > 0 || controller->frame_pending) {
+            snakecontroller_present_capped(controller);
+        }
+        snakecontroller_publish(controller);
+        if (playing == timer_paused(controller->timer)) {
+            if (playing) {
+                timer_unpause(controller->timer);
+            } else {
+                timer_pause(controller->timer);
+            }
+        }
+    }
+}
+
+// renders every tick of a replay as fast as it can and reports where the
+// frame time went, for comparing renderers on the same recording; quits
+void snakecontroller_replay_bench(SnakeController *controller,
+                                  ReplayPlayer *player, const char *name) {
+    timer_start(controller->timer);
+    snakecontroller_present(controller);
+
+    int64_t frames = 0;
+    int64_t start_ns = timer_now_ns();
+    while (true) {
+        int64_t start = timer_now_ns();
+        if (replay_player_step(player) == false) {
+            break;
         }
+        snakecontroller_stage(controller, STAGE_update, start);
+        controller->continues = player->continues;
+        controller->tick = player->tick;
+        snakecontroller_present(controller);
+        frames++;
+    }
+    double elapsed = (timer_now_ns() - start_ns) / 1e9;
+
+    Histogram stages[STAGE_count];
+    snakecontroller_collect(controller);
+    memcpy(stages, controller->stages, sizeof stages);
+    snakecontroller_quit(controller);
+
+    printf("renderer   %s\n", name);
+    printf("frames     %lld\n", (long long)frames);
+    printf("elapsed    %.3f s\n", elapsed);
+    printf("frames/sec %.0f\n", elapsed > 0 ? frames / elapsed : 0);
+    printf("%-10s %7s %7s %7s\n", "stage", "p50", "p99", "max");
+    for (int i = STAGE_update; i <= STAGE_flush; i++) {
+        char p50[16], p99[16], max[16];
+        histogram_format_ns(p50, sizeof p50,
+                            histogram_percentile(&stages[i], 50));
+        histogram_format_ns(p99, sizeof p99,
+                            histogram_percentile(&stages[i], 99));
+        histogram_format_ns(max, sizeof max, stages[i].max);
+        printf("%-10s %7s %7s %7s\n", stage_names[i], p50, p99, max);
+    }
+}
+
+// re-simulates a replay without a terminal as fast as the CPU allows, up to
+// the end or to tick from if that is not negative
+int replay_headless(const char *path, int64_t from) {
+    ReplayReader *reader = replay_reader_open(path);
+    if (reader == NULL) {
+        fprintf(stderr, "%s: not a replay\n", path);
+        return EXIT_FAILURE;
+    }
+    ReplayHeader header = replay_reader_header(reader);
+    Snake *model = snake_new(header.nlines, header.ncols, header.seed);
+    if (model == NULL) {
+        fprintf(stderr, "%s\n", snake_error_str(SNAKE_ERROR_alloc));
+        replay_reader_close(reader);
+        return EXIT_FAILURE;
+    }
+
+    ReplayPlayer player;
+    replay_player_init(&player, reader, model);
+    int64_t start_ns = timer_now_ns();
+    if (from >= 0) {
+        if (replay_player_seek(&player, from) == false) {
+            fprintf(stderr, "%s: ends before tick %lld\n", path,
+                    (long long)from);
+        }
+    } else {
+        while (replay_player_step(&player)) {
+            snake_clear_dirty(model);
+        }
+    }
+    double elapsed = (timer_now_ns() - start_ns) / 1e9;
+
+    printf("board      %dx%d\n", header.nlines, header.ncols);
+    printf("seed       %llu\n", (unsigned long long)header.seed);
+    printf("keyframes  %d every %u ticks\n", replay_reader_keyframes(reader),
+           header.keyframe_interval);
+    printf("ticks      %lld\n", (long long)player.tick);
+    printf("games      %d\n", player.games);
+    printf("score      %d\n", model->deq->length);
+    printf("continues  %d\n", player.continues);
+    printf("elapsed    %.3f s\n", elapsed);
+    printf("ticks/sec  %.0f\n", elapsed > 0 ? player.tick / elapsed : 0);
+
+    snake_destroy(model);
+    replay_reader_close(reader);
+    return EXIT_SUCCESS;
+}
 
-        napms(controller->delay_ms);
+void usage(const char *prog) {
+    int width = strlen(prog);
+    fprintf(stderr,
+            "usage: %s [--glyphs G] [--renderer R] [--fps N]\n"
+            "       %*s [--autopilot] [--pilot P]\n"
+            "       %*s [--record FILE [--keyframes N]]\n"
+            "       %*s [nlines [ncols] | max]\n"
+            "       %s --replay FILE [--from TICK]\n"
+            "       %*s [--render [--glyphs G] [--renderer R]\n"
+            "       %*s  [--speed X [--fps N] | --bench]]\n"
+            "glyphs: block (default), half, half-wide\n"
+            "renderers:",
+            prog, width, "", width, "", width, "", prog, width, "", width, "");
+    // the first backend that starts is the default
+    for (RendererBackend const *const *r = renderer_all(); *r != NULL; r++) {
+        fprintf(stderr, "%s %s%s", r == renderer_all() ? "" : ",", (*r)->name,
+                r == renderer_all() ? " (default)" : "");
     }
+    fprintf(stderr,
+            "\n"
+            "           ansi draws on its own thread and needs a UTF-8 locale,\n"
+            "           curses draws between ticks and is used without one\n"
+            "fps: frames drawn per second at most, %d by default\n"
+            "autopilot: play by itself from the start, a toggles it\n"
+            "pilots: bfs (default), greedy, random,\n"
+            "        hamilton (always wins, needs an even nlines or ncols),\n"
+            "        mcts (searches for half of every tick)\n",
+            DEFAULT_FPS);
+    exit(1);
 }
 
 int main(int argc, char *argv[]) {
-    srand(time(NULL));
+    const char *record_path = NULL;
+    const char *replay_path = NULL;
+    bool render = false;
+    bool bench = false;
+    bool autopilot = false;
+    Policy const *pilot = policy_find("bfs");
+    bool pilot_set = false;
+    // NULL until given
+    RendererBackend const *backend = NULL;
+    double speed = 1;
+    // 0 until given
+    double fps = 0;
+    long keyframes = REPLAY_KEYFRAME_INTERVAL;
+    long long from = -1;
+    enum GLYPHS glyphs = GLYPHS_block;
+    bool glyphs_set = false;
+    char *dims[2];
+    int ndims = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--render") == 0) {
+            render = true;
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            bench = true;
+        } else if (strcmp(argv[i], "--autopilot") == 0) {
+            autopilot = true;
+        } else if (strcmp(argv[i], "--pilot") == 0 && i + 1 < argc) {
+            pilot = policy_find(argv[++i]);
+            if (pilot == NULL) {
+                usage(argv[0]);
+            }
+            pilot_set = true;
+        } else if (strcmp(argv[i], "--renderer") == 0 && i + 1 < argc) {
+            backend = renderer_find(argv[++i]);
+            if (backend == NULL) {
+                usage(argv[0]);
+            }
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            speed = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            fps = strtod(argv[++i], NULL);
+            if (fps <= 0) {
+                usage(argv[0]);
+            }
+        } else if (strcmp(argv[i], "--keyframes") == 0 && i + 1 < argc) {
+            keyframes = strtol(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            from = strtoll(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--glyphs") == 0 && i + 1 < argc) {
+            const char *name = argv[++i];
+            if (strcmp(name, "block") == 0) {
+                glyphs = GLYPHS_block;
+            } else if (strcmp(name, "half") == 0) {
+                glyphs = GLYPHS_half;
+            } else if (strcmp(name, "half-wide") == 0) {
+                glyphs = GLYPHS_half_wide;
+            } else {
+                usage(argv[0]);
+            }
+            glyphs_set = true;
+        } else if (argv[i][0] != '-' && ndims < 2) {
+            dims[ndims++] = argv[i];
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (speed <= 0 || keyframes < 0 || keyframes > UINT32_MAX ||
+        (replay_path != NULL && (ndims > 0 || autopilot || pilot_set)) ||
+        (replay_path == NULL && (render || speed != 1 || from >= 0)) ||
+        (replay_path != NULL && render == false &&
+         (glyphs_set || backend != NULL || fps > 0)) ||
+        (bench && (render == false || fps > 0))) {
+        usage(argv[0]);
+    }
+    if (replay_path != NULL && render == false) {
+        return replay_headless(replay_path, from);
+    }
+
+    ReplayReader *reader = NULL;
+    ReplayHeader header;
+    if (replay_path != NULL) {
+        reader = replay_reader_open(replay_path);
+        if (reader == NULL) {
+            fprintf(stderr, "%s: not a replay\n", replay_path);
+            exit(1);
+        }
+        header = replay_reader_header(reader);
+    }
+
     setlocale(LC_ALL, "");
+    if (glyphs != GLYPHS_block && MB_CUR_MAX == 1) {
+        fprintf(stderr, "half-block glyphs need a UTF-8 locale\n");
+        exit(1);
+    }
 
     initscr();
     cbreak();
@@ -660,44 +1905,129 @@ int main(int argc, char *argv[]) {
 
     use_default_colors();
     start_color();
-    init_pair(PAIR_SNAKE, COLOR_SNAKE, -1);
-    init_pair(PAIR_FOOD, COLOR_FOOD, -1);
-    init_pair(PAIR_BORDER, COLOR_BORDER, -1);
 
+    // ncurses 6.4 flushes after every cursor move until the screen has been
+    // suspended once; a round trip now makes each doupdate a single write
+    endwin();
     refresh();
 
+    Renderer *renderer = NULL;
+    if (backend != NULL) {
+        renderer = renderer_new(backend);
+    } else {
+        // the first that starts: ansi, drawing on its own thread, in a
+        // UTF-8 locale and curses in any other
+        for (RendererBackend const *const *r = renderer_all();
+             renderer == NULL && *r != NULL; r++) {
+            backend = *r;
+            renderer = renderer_new(backend);
+        }
+    }
+    if (renderer == NULL) {
+        endwin();
+        fprintf(stderr, "could not start the %s renderer%s\n", backend->name,
+                MB_CUR_MAX == 1 ? ", it needs a UTF-8 locale" : "");
+        exit(1);
+    }
+    renderer_set_pair(renderer, PAIR_SNAKE, COLOR_SNAKE, -1);
+    renderer_set_pair(renderer, PAIR_FOOD, COLOR_FOOD, -1);
+    renderer_set_pair(renderer, PAIR_BORDER, COLOR_BORDER, -1);
+    renderer_set_pair(renderer, PAIR_SNAKE_OVER_FOOD, COLOR_SNAKE, COLOR_FOOD);
+    renderer_set_pair(renderer, PAIR_FOOD_OVER_SNAKE, COLOR_FOOD, COLOR_SNAKE);
+    int screen_nlines, screen_ncols;
+    renderer_size(renderer, &screen_nlines, &screen_ncols);
+
     int nlines = DEFAULT_LENGTH;
     int ncols = DEFAULT_LENGTH;
 
-    if (argc == 2) {
-        if (strcmp(argv[1], "MAX") != 0 || strcmp(argv[1], "max") != 0) {
-            nlines = (LINES - 2 - 3) / 2;
-            ncols = (COLS - 2) / 2;
+    if (reader != NULL) {
+        nlines = header.nlines;
+        ncols = header.ncols;
+    } else if (ndims == 1) {
+        if (strcmp(dims[0], "MAX") == 0 || strcmp(dims[0], "max") == 0) {
+            glyphs_board_size(glyphs, screen_nlines - 2 - 3,
+                              screen_ncols - 2, &nlines, &ncols);
+            // a pilot that cannot play the full board (hamilton on odd by
+            // odd) gets it one row shorter
+            if (pilot_set && nlines > 1 &&
+                pilot_fits(pilot, nlines, ncols) == false) {
+                nlines--;
+            }
         } else {
-            nlines = strtol(argv[1], NULL, 0);
-            ncols = strtol(argv[1], NULL, 0);
+            nlines = strtol(dims[0], NULL, 0);
+            ncols = strtol(dims[0], NULL, 0);
         }
-    } else if (argc == 3) {
-        nlines = strtol(argv[1], NULL, 0);
-        ncols = strtol(argv[2], NULL, 0);
+    } else if (ndims == 2) {
+        nlines = strtol(dims[0], NULL, 0);
+        ncols = strtol(dims[1], NULL, 0);
     }
-    int view_nlines = nlines * 2 + 2 + 3;
-    int view_ncols = ncols * 2 + 2;
-
-    if (view_nlines > LINES || view_ncols > COLS || nlines * 2 < END_NLINES ||
-        ncols * 2 < END_NCOLS || nlines * 2 < HELP_NLINES ||
-        ncols * 2 < HELP_NCOLS || nlines <= 0 || ncols <= 0) {
+    int board_nlines, board_ncols;
+    glyphs_view_size(glyphs, nlines, ncols, &board_nlines, &board_ncols);
+    int view_nlines = board_nlines + 2 + 3;
+    int view_ncols = board_ncols + 2;
+
+    // the help and end popups may overhang the board but not the screen
+    if (view_nlines > screen_nlines || view_ncols > screen_ncols ||
+        screen_nlines < END_NLINES || screen_ncols < END_NCOLS ||
+        screen_nlines < HELP_NLINES || screen_ncols < HELP_NCOLS ||
+        nlines <= 0 || ncols <= 0) {
+        renderer_destroy(renderer);
         endwin();
         fprintf(stderr, "invalid dimensions\n");
         exit(1);
     }
 
-    SnakeController *controller =
-        snakecontroller_new(nlines, ncols, 4, (COLS - ncols * 2) / 2);
-    snakecontroller_loop(controller);
-    snakecontroller_destroy(controller);
+    uint64_t seed = reader != NULL ? header.seed : (uint64_t)time(NULL);
+    Screen *screen = screen_new(renderer, nlines, ncols, glyphs, 4,
+                                (screen_ncols - board_ncols) / 2);
+    // the bench times drawing itself, so it draws in line, and so does a
+    // backend that shares curses with the key reads
+    SnakeController *controller = snakecontroller_new(
+        screen, !bench && renderer_threadable(renderer), nlines, ncols, seed);
+    if (controller == NULL) {
+        screen_destroy(screen);
+        endwin();
+        fprintf(stderr, "%s\n", snake_error_str(SNAKE_ERROR_alloc));
+        exit(1);
+    }
+    if (fps > 0) {
+        snakecontroller_set_fps(controller, fps);
+    }
 
-    endwin();
+    if (reader != NULL) {
+        ReplayPlayer player;
+        replay_player_init(&player, reader, controller->model);
+        if (from >= 0) {
+            replay_player_seek(&player, from);
+        }
+        if (bench) {
+            snakecontroller_replay_bench(controller, &player, backend->name);
+        } else {
+            snakecontroller_replay_loop(controller, &player, speed);
+            snakecontroller_quit(controller);
+        }
+        replay_reader_close(reader);
+        return EXIT_SUCCESS;
+    }
+
+    if (record_path != NULL &&
+        snakecontroller_record_to(controller, record_path, seed, keyframes) ==
+            false) {
+        snakecontroller_quit(controller);
+        fprintf(stderr, "%s: could not create replay\n", record_path);
+        exit(1);
+    }
+    if (snakecontroller_set_pilot(controller, pilot, seed) == false) {
+        snakecontroller_quit(controller);
+        fprintf(stderr, "the %s autopilot cannot play a %dx%d board\n",
+                pilot->name, nlines, ncols);
+        exit(1);
+    }
+    if (autopilot) {
+        snakecontroller_set_autopilot(controller, true);
+    }
+    snakecontroller_loop(controller);
+    snakecontroller_quit(controller);
 
     return EXIT_SUCCESS;
 }
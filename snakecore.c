@@ -0,0 +1,385 @@
+#include "snakecore.h"
+#include <stdlib.h>
+#include <string.h>
+
+const char *snake_error_str(enum SNAKE_ERROR err) {
+    switch (err) {
+    case SNAKE_ERROR_none:
+        return "no error";
+    case SNAKE_ERROR_alloc:
+        return "out of memory";
+    case SNAKE_ERROR_inactive:
+        return "snake is not active";
+    case SNAKE_ERROR_null_direction:
+        return "null direction";
+    case SNAKE_ERROR_no_body:
+        return "snake has no nodes";
+    case SNAKE_ERROR_no_free_cell:
+        return "no free cell for food";
+    case SNAKE_ERROR_invalid_body:
+        return "invalid snake body";
+    }
+    return "unknown error";
+}
+
+void snake_mark_dirty(Snake *snake, Pose pos) {
+    if (snake->ndirty == snake->nlines * snake->ncols) {
+        snake->dirty_all = true;
+        return;
+    }
+    snake->dirty[snake->ndirty++] = pos;
+}
+
+void snake_mark_all_dirty(Snake *snake) {
+    snake->dirty_all = true;
+}
+
+void snake_clear_dirty(Snake *snake) {
+    snake->ndirty = 0;
+    snake->dirty_all = false;
+}
+
+static bool *snake_cell(Snake *snake, Pose pos) {
+    return &snake->occupied[pos.y * snake->ncols + pos.x];
+}
+
+static void snake_take_cell(Snake *snake, Pose pos) {
+    int cell = pos.y * snake->ncols + pos.x;
+    int slot = snake->free_slot[cell];
+    int last = snake->free_cells[--snake->nfree];
+
+    snake->free_cells[slot] = last;
+    snake->free_slot[last] = slot;
+    snake->free_slot[cell] = -1;
+    *snake_cell(snake, pos) = true;
+    snake_mark_dirty(snake, pos);
+}
+
+static void snake_release_cell(Snake *snake, Pose pos) {
+    int cell = pos.y * snake->ncols + pos.x;
+
+    snake->free_cells[snake->nfree] = cell;
+    snake->free_slot[cell] = snake->nfree++;
+    *snake_cell(snake, pos) = false;
+    snake_mark_dirty(snake, pos);
+}
+
+static void snake_push_head(Snake *snake, Pose pos) {
+    if (snake->flipped == false) {
+        deque_push_front(snake->deq, pos);
+    } else {
+        deque_push_back(snake->deq, pos);
+    }
+    snake_take_cell(snake, pos);
+}
+
+static void snake_pop_tail(Snake *snake) {
+    Pose pos;
+    if (snake->flipped == false) {
+        pos = deque_pop_back(snake->deq);
+    } else {
+        pos = deque_pop_front(snake->deq);
+    }
+    snake_release_cell(snake, pos);
+}
+
+// empties the board: no body, every cell free, nothing to draw but all of it
+static void snake_clear_board(Snake *snake) {
+    deque_clear(snake->deq);
+    memset(snake->occupied, 0,
+           snake->nlines * snake->ncols * sizeof *snake->occupied);
+    snake->nfree = snake->nlines * snake->ncols;
+    for (int i = 0; i < snake->nfree; i++) {
+        snake->free_cells[i] = i;
+        snake->free_slot[i] = i;
+    }
+    snake->ndirty = 0;
+    snake->dirty_all = true;
+
+    snake->dir = DIRECTION_null;
+    snake->state = STATE_null;
+    snake->flipped = false;
+}
+
+enum SNAKE_ERROR snake_find_food_pos(Snake *snake, Pose *pos) {
+    if (snake->nfree == 0) {
+        return SNAKE_ERROR_no_free_cell;
+    }
+
+    int cell = snake->free_cells[rng_below(&snake->rng, snake->nfree)];
+    *pos = (Pose){.y = cell / snake->ncols, .x = cell % snake->ncols};
+    return SNAKE_ERROR_none;
+}
+
+size_t snake_arena_size(int nlines, int ncols) {
+    size_t ncells = (size_t)nlines * ncols;
+    return arena_footprint(sizeof(Snake)) + arena_footprint(sizeof(Deque)) +
+           arena_footprint(ncells * sizeof(Pose)) +
+           arena_footprint(ncells * sizeof(bool)) +
+           2 * arena_footprint(ncells * sizeof(int)) +
+           arena_footprint(ncells * sizeof(Pose));
+}
+
+Snake *snake_new_in(Arena *arena, int nlines, int ncols, uint64_t seed) {
+    size_t ncells = (size_t)nlines * ncols;
+    if (arena->size - arena->used < snake_arena_size(nlines, ncols)) {
+        return NULL;
+    }
+    Snake *snake = arena_alloc(arena, sizeof *snake);
+    snake->nlines = nlines;
+    snake->ncols = ncols;
+    snake->deq = arena_alloc(arena, sizeof *snake->deq);
+    deque_init(snake->deq, arena_alloc(arena, ncells * sizeof(Pose)), ncells);
+    snake->occupied = arena_alloc(arena, ncells * sizeof *snake->occupied);
+    snake->free_cells = arena_alloc(arena, ncells * sizeof *snake->free_cells);
+    snake->free_slot = arena_alloc(arena, ncells * sizeof *snake->free_slot);
+    snake->dirty = arena_alloc(arena, ncells * sizeof *snake->dirty);
+    snake->block = NULL;
+
+    snake_reset(snake, seed);
+    return snake;
+}
+
+Snake *snake_new(int nlines, int ncols, uint64_t seed) {
+    Arena arena;
+    if (arena_init(&arena, snake_arena_size(nlines, ncols)) == false) {
+        return NULL;
+    }
+    Snake *snake = snake_new_in(&arena, nlines, ncols, seed);
+    snake->block = arena.base;
+    return snake;
+}
+
+void snake_reset(Snake *snake, uint64_t seed) {
+    snake_clear_board(snake);
+    rng_seed(&snake->rng, seed);
+
+    snake_push_head(snake,
+                    (Pose){.y = snake->nlines / 2, .x = snake->ncols / 2});
+
+    snake_find_food_pos(snake, &snake->food_pos);
+}
+
+// the board of a new game, used to recover from a rejected body
+static void snake_reset_board(Snake *snake) {
+    snake_clear_board(snake);
+    snake_push_head(snake,
+                    (Pose){.y = snake->nlines / 2, .x = snake->ncols / 2});
+    snake_find_food_pos(snake, &snake->food_pos);
+}
+
+enum SNAKE_ERROR snake_set_body(Snake *snake, Pose const *body, int length) {
+    if (length <= 0 || length > snake->nlines * snake->ncols) {
+        return SNAKE_ERROR_invalid_body;
+    }
+    for (int i = 0; i < length; i++) {
+        if (snake_pos_out_of_bounds(snake, body[i])) {
+            return SNAKE_ERROR_invalid_body;
+        }
+    }
+
+    snake_clear_board(snake);
+    for (int i = 0; i < length; i++) {
+        if (snake_contains_pos(snake, body[i])) {
+            snake_reset_board(snake);
+            return SNAKE_ERROR_invalid_body;
+        }
+        deque_push_back(snake->deq, body[i]);
+        snake_take_cell(snake, body[i]);
+    }
+    snake->ndirty = 0;
+
+    if (snake_contains_pos(snake, snake->food_pos) && snake->nfree > 0) {
+        snake_find_food_pos(snake, &snake->food_pos);
+    }
+    return SNAKE_ERROR_none;
+}
+
+enum SNAKE_ERROR snake_restore_board(Snake *snake, Pose const *body,
+                                     int length, int const *free_cells) {
+    int ncells = snake->nlines * snake->ncols;
+    if (length <= 0 || length > ncells) {
+        return SNAKE_ERROR_invalid_body;
+    }
+    for (int i = 0; i < length; i++) {
+        if (snake_pos_out_of_bounds(snake, body[i])) {
+            return SNAKE_ERROR_invalid_body;
+        }
+    }
+
+    snake_clear_board(snake);
+    for (int i = 0; i < length; i++) {
+        if (snake_contains_pos(snake, body[i])) {
+            snake_reset_board(snake);
+            return SNAKE_ERROR_invalid_body;
+        }
+        deque_push_back(snake->deq, body[i]);
+        *snake_cell(snake, body[i]) = true;
+    }
+
+    // every cell the body leaves must be listed exactly once
+    for (int i = 0; i < ncells; i++) {
+        snake->free_slot[i] = -1;
+    }
+    snake->nfree = ncells - length;
+    for (int i = 0; i < snake->nfree; i++) {
+        int cell = free_cells[i];
+        if (cell < 0 || cell >= ncells || snake->occupied[cell] ||
+            snake->free_slot[cell] != -1) {
+            snake_reset_board(snake);
+            return SNAKE_ERROR_invalid_body;
+        }
+        snake->free_cells[i] = cell;
+        snake->free_slot[cell] = i;
+    }
+    return SNAKE_ERROR_none;
+}
+
+void snake_destroy(Snake *snake) {
+    free(snake->block);
+}
+
+void snake_set_direction(Snake *snake, enum DIRECTION dir) {
+
+    switch (snake->dir) {
+    case DIRECTION_left:
+        if (dir != DIRECTION_right) {
+            snake->dir = dir;
+        }
+        break;
+    case DIRECTION_right:
+        if (dir != DIRECTION_left) {
+            snake->dir = dir;
+        }
+        break;
+    case DIRECTION_up:
+        if (dir != DIRECTION_down) {
+            snake->dir = dir;
+        }
+        break;
+    case DIRECTION_down:
+        if (dir != DIRECTION_up) {
+            snake->dir = dir;
+        }
+        break;
+    default:
+        snake->dir = dir;
+        break;
+    }
+    snake->state = STATE_active;
+}
+
+enum SNAKE_ERROR snake_flip(Snake *snake) {
+    if (snake->dir == DIRECTION_null) {
+        return SNAKE_ERROR_none;
+    }
+
+    if (snake->deq->length == 0) {
+        return SNAKE_ERROR_no_body;
+    }
+
+    if (snake->deq->length == 1) {
+        switch (snake->dir) {
+        case DIRECTION_left:
+            snake->dir = DIRECTION_right;
+            break;
+        case DIRECTION_right:
+            snake->dir = DIRECTION_left;
+            break;
+        case DIRECTION_up:
+            snake->dir = DIRECTION_down;
+            break;
+        case DIRECTION_down:
+            snake->dir = DIRECTION_up;
+            break;
+        default:
+            return SNAKE_ERROR_null_direction;
+        }
+    } else {
+        Pose last_pos = deque_get(snake->deq, snake->deq->length - 1);
+        Pose second_last_pos = deque_get(snake->deq, snake->deq->length - 2);
+        if (snake->flipped == true) {
+            last_pos = deque_get(snake->deq, 0);
+            second_last_pos = deque_get(snake->deq, 1);
+        }
+        Pose displacement = {.y = second_last_pos.y - last_pos.y,
+                             .x = second_last_pos.x - last_pos.x};
+
+        if (pose_equal(displacement, (Pose){.y = 0, .x = -1})) {
+            snake->dir = DIRECTION_right;
+        } else if (pose_equal(displacement, (Pose){.y = 0, .x = 1})) {
+            snake->dir = DIRECTION_left;
+        } else if (pose_equal(displacement, (Pose){.y = -1, .x = 0})) {
+            snake->dir = DIRECTION_down;
+        } else if (pose_equal(displacement, (Pose){.y = 1, .x = 0})) {
+            snake->dir = DIRECTION_up;
+        }
+    }
+    snake->flipped = !snake->flipped;
+    snake->state = STATE_active;
+    return SNAKE_ERROR_none;
+}
+
+Pose snake_get_head(Snake const *snake) {
+    if (snake->flipped == true) {
+        return deque_get_tail(snake->deq);
+    }
+    return deque_get_head(snake->deq);
+}
+
+bool snake_pos_out_of_bounds(Snake const *snake, Pose pos) {
+    return (pos.y < 0 || pos.y > snake->nlines - 1 || pos.x < 0 ||
+            pos.x > snake->ncols - 1);
+}
+
+bool snake_contains_pos(Snake const *snake, Pose pos) {
+    return snake->occupied[pos.y * snake->ncols + pos.x];
+}
+
+enum SNAKE_ERROR snake_update(Snake *snake) {
+    if (snake->state != STATE_active) {
+        return SNAKE_ERROR_inactive;
+    }
+
+    Pose next_pos = snake_get_head(snake);
+
+    switch (snake->dir) {
+    case DIRECTION_left:
+        next_pos.x--;
+        break;
+    case DIRECTION_right:
+        next_pos.x++;
+        break;
+    case DIRECTION_up:
+        next_pos.y--;
+        break;
+    case DIRECTION_down:
+        next_pos.y++;
+        break;
+    default:
+        return SNAKE_ERROR_null_direction;
+    }
+
+    if (snake_pos_out_of_bounds(snake, next_pos) ||
+        snake_contains_pos(snake, next_pos)) {
+        snake->state = STATE_lose;
+        return SNAKE_ERROR_none;
+    }
+
+    snake_push_head(snake, next_pos);
+
+    if (pose_equal(next_pos, snake->food_pos) == true) {
+        if (snake->deq->length == snake->nlines * snake->ncols) {
+            snake->state = STATE_win;
+        } else {
+            enum SNAKE_ERROR err = snake_find_food_pos(snake, &snake->food_pos);
+            if (err != SNAKE_ERROR_none) {
+                return err;
+            }
+            snake_mark_dirty(snake, snake->food_pos);
+        }
+    } else {
+        snake_pop_tail(snake);
+    }
+    return SNAKE_ERROR_none;
+}
@@ -0,0 +1,108 @@
+#ifndef SNAKECORE_H
+#define SNAKECORE_H
+
+#include "arena.h"
+#include "deque.h"
+#include "rng.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// a game that goes this many ticks per cell without eating is abandoned as
+// stalled, by snake-batch and vecenv alike
+#define SNAKE_STALL_TICKS_PER_CELL 4
+
+enum DIRECTION {
+    DIRECTION_null,
+    DIRECTION_left,
+    DIRECTION_right,
+    DIRECTION_up,
+    DIRECTION_down,
+};
+
+enum STATE {
+    STATE_null,
+    STATE_lose,
+    STATE_win,
+    STATE_active,
+};
+
+enum SNAKE_ERROR {
+    SNAKE_ERROR_none,
+    SNAKE_ERROR_alloc,
+    SNAKE_ERROR_inactive,
+    SNAKE_ERROR_null_direction,
+    SNAKE_ERROR_no_body,
+    SNAKE_ERROR_no_free_cell,
+    SNAKE_ERROR_invalid_body,
+};
+
+typedef struct Snake {
+    int nlines;
+    int ncols;
+    enum DIRECTION dir;
+    enum STATE state;
+    bool flipped;
+    Deque *deq;
+    bool *occupied;
+    // dense list of unoccupied cell indices and each cell's slot in it
+    int *free_cells;
+    int *free_slot;
+    int nfree;
+    // cells changed since the view last drew, or dirty_all for a full repaint
+    Pose *dirty;
+    int ndirty;
+    bool dirty_all;
+    Pose food_pos;
+    Rng rng;
+    // what snake_destroy frees, NULL for a snake in the caller's arena
+    void *block;
+} Snake;
+
+const char *snake_error_str(enum SNAKE_ERROR err);
+
+// returns NULL if the board could not be allocated
+Snake *snake_new(int nlines, int ncols, uint64_t seed);
+
+// bytes snake_new_in takes from an arena
+size_t snake_arena_size(int nlines, int ncols);
+
+// carves the snake out of arena, NULL if it has too little room left; it
+// goes when the arena is released, snake_destroy leaves it alone
+Snake *snake_new_in(Arena *arena, int nlines, int ncols, uint64_t seed);
+
+void snake_destroy(Snake *snake);
+
+// starts a new game on the same board, as snake_new would with seed,
+// without allocating
+void snake_reset(Snake *snake, uint64_t seed);
+
+// replaces the body, head first, leaving the snake waiting for a direction
+enum SNAKE_ERROR snake_set_body(Snake *snake, Pose const *body, int length);
+
+// replaces the body, in deque order, and the free list, whose order decides
+// where later food lands; the caller restores dir, state, flipped, food_pos
+// and rng
+enum SNAKE_ERROR snake_restore_board(Snake *snake, Pose const *body,
+                                     int length, int const *free_cells);
+
+enum SNAKE_ERROR snake_find_food_pos(Snake *snake, Pose *pos);
+
+void snake_set_direction(Snake *snake, enum DIRECTION dir);
+
+enum SNAKE_ERROR snake_flip(Snake *snake);
+
+enum SNAKE_ERROR snake_update(Snake *snake);
+
+Pose snake_get_head(Snake const *snake);
+
+bool snake_pos_out_of_bounds(Snake const *snake, Pose pos);
+
+bool snake_contains_pos(Snake const *snake, Pose pos);
+
+void snake_mark_dirty(Snake *snake, Pose pos);
+
+void snake_mark_all_dirty(Snake *snake);
+
+void snake_clear_dirty(Snake *snake);
+
+#endif // !SNAKECORE_H
@@ -0,0 +1,148 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "histogram.h"
+#include "statspage.h"
+#include <dirent.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SHM_DIR "/dev/shm"
+#define MAX_PIDS 256
+
+static void usage(const char *prog) {
+    fprintf(stderr, "usage: %s [-i interval_ms] [-n samples] [pid...]\n",
+            prog);
+    exit(1);
+}
+
+// every pid with a stats page whose process is still alive
+static int find_pids(pid_t *pids, int max) {
+    DIR *dir = opendir(SHM_DIR);
+    if (dir == NULL) {
+        return 0;
+    }
+    int npids = 0;
+    struct dirent *entry;
+    size_t prefix_len = strlen(STATSPAGE_PREFIX);
+    while ((entry = readdir(dir)) != NULL && npids < max) {
+        if (strncmp(entry->d_name, STATSPAGE_PREFIX, prefix_len) != 0) {
+            continue;
+        }
+        pid_t pid = strtol(entry->d_name + prefix_len, NULL, 10);
+        // pages of crashed games stay behind
+        if (pid > 0 && (kill(pid, 0) == 0 || errno == EPERM)) {
+            pids[npids++] = pid;
+        }
+    }
+    closedir(dir);
+    return npids;
+}
+
+static void print_snapshot(pid_t pid, StatsSnapshot const *snapshot) {
+    printf("pid %ld  tick %lld  score %d/%d  delay %.1fms  continues %d\n",
+           (long)pid, (long long)snapshot->tick, snapshot->score,
+           snapshot->max_score, snapshot->delay_ms, snapshot->continues);
+    printf("  allocs %llu  frees %llu  bytes %llu\n",
+           (unsigned long long)snapshot->allocs,
+           (unsigned long long)snapshot->frees,
+           (unsigned long long)snapshot->alloc_bytes);
+    printf("  %-8s %10s %8s %8s %8s\n", "stage", "count", "p50", "p99",
+           "max");
+    int nstages = snapshot->nstages < STATSPAGE_STAGES ? snapshot->nstages
+                                                       : STATSPAGE_STAGES;
+    for (int i = 0; i < nstages; i++) {
+        Histogram const *hist = &snapshot->stages[i];
+        char p50[16], p99[16], max[16];
+        histogram_format_ns(p50, sizeof p50, histogram_percentile(hist, 50));
+        histogram_format_ns(p99, sizeof p99, histogram_percentile(hist, 99));
+        histogram_format_ns(max, sizeof max, hist->max);
+        printf("  %-8.*s %10llu %8s %8s %8s\n", STATSPAGE_NAME_LEN,
+               snapshot->stage_names[i], (unsigned long long)hist->total, p50,
+               p99, max);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    long interval_ms = 1000;
+    long samples = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "i:n:")) != -1) {
+        switch (opt) {
+        case 'i':
+            interval_ms = strtol(optarg, NULL, 0);
+            break;
+        case 'n':
+            samples = strtol(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (interval_ms < 0 || samples <= 0 || argc - optind > MAX_PIDS) {
+        usage(argv[0]);
+    }
+
+    pid_t pids[MAX_PIDS];
+    int npids = 0;
+    for (int i = optind; i < argc; i++) {
+        pids[npids++] = strtol(argv[i], NULL, 10);
+    }
+    if (npids == 0) {
+        npids = find_pids(pids, MAX_PIDS);
+    }
+    if (npids == 0) {
+        fprintf(stderr, "no running games\n");
+        return EXIT_FAILURE;
+    }
+
+    // mapped once, so sampling costs the game nothing but cache misses
+    StatsPage const *pages[MAX_PIDS];
+    for (int i = 0; i < npids; i++) {
+        pages[i] = statspage_open(pids[i]);
+        if (pages[i] == NULL) {
+            fprintf(stderr, "%ld: no stats page\n", (long)pids[i]);
+        }
+    }
+
+    StatsSnapshot *snapshot = malloc(sizeof *snapshot);
+    if (snapshot == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    struct timespec interval = {
+        .tv_sec = interval_ms / 1000,
+        .tv_nsec = interval_ms % 1000 * 1000000,
+    };
+    for (long sample = 0; sample < samples; sample++) {
+        if (sample > 0) {
+            nanosleep(&interval, NULL);
+            printf("\n");
+        }
+        for (int i = 0; i < npids; i++) {
+            if (pages[i] == NULL) {
+                continue;
+            }
+            if (statspage_read(pages[i], snapshot) == false) {
+                printf("pid %ld  stuck mid update\n", (long)pids[i]);
+                continue;
+            }
+            print_snapshot(pids[i], snapshot);
+        }
+        fflush(stdout);
+    }
+
+    for (int i = 0; i < npids; i++) {
+        if (pages[i] != NULL) {
+            statspage_close(pages[i]);
+        }
+    }
+    free(snapshot);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "statspage.h"
+
+// a reader gives up after this many torn copies in a row
+#define READ_ATTEMPTS 1000
+
+static void
+statspage_name(char *buf, size_t size, pid_t pid)
+{
+    snprintf(buf, size, "/" STATSPAGE_PREFIX "%ld", (long) pid);
+}
+
+StatsPage *
+statspage_create(void)
+{
+    char name[64];
+    statspage_name(name, sizeof name, getpid());
+
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    if (ftruncate(fd, sizeof(StatsPage)) != 0)
+    {
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    StatsPage *page = mmap(NULL, sizeof *page, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, fd, 0);
+    close(fd);
+    if (page == MAP_FAILED)
+    {
+        shm_unlink(name);
+        return NULL;
+    }
+
+    // the object starts zeroed, so seq is even and the snapshot empty
+    page->version = STATSPAGE_VERSION;
+    page->pid = getpid();
+    atomic_thread_fence(memory_order_release);
+    page->magic = STATSPAGE_MAGIC;
+
+    return page;
+}
+
+void
+statspage_destroy(StatsPage *page)
+{
+    char name[64];
+    statspage_name(name, sizeof name, page->pid);
+    munmap(page, sizeof *page);
+    shm_unlink(name);
+}
+
+StatsSnapshot *
+statspage_begin(StatsPage *page)
+{
+    unsigned seq = atomic_load_explicit(&page->seq, memory_order_relaxed);
+    atomic_store_explicit(&page->seq, seq + 1, memory_order_relaxed);
+    // the odd seq must be visible before any of the writes that follow
+    atomic_thread_fence(memory_order_release);
+    return &page->snapshot;
+}
+
+void
+statspage_end(StatsPage *page)
+{
+    unsigned seq = atomic_load_explicit(&page->seq, memory_order_relaxed);
+    atomic_store_explicit(&page->seq, seq + 1, memory_order_release);
+}
+
+StatsPage const *
+statspage_open(pid_t pid)
+{
+    char name[64];
+    statspage_name(name, sizeof name, pid);
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    StatsPage *page = mmap(NULL, sizeof *page, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (page == MAP_FAILED)
+    {
+        return NULL;
+    }
+    if (page->magic != STATSPAGE_MAGIC || page->version != STATSPAGE_VERSION)
+    {
+        munmap(page, sizeof *page);
+        return NULL;
+    }
+    return page;
+}
+
+void
+statspage_close(StatsPage const *page)
+{
+    munmap((void *) page, sizeof *page);
+}
+
+bool
+statspage_read(StatsPage const *page, StatsSnapshot *snapshot)
+{
+    // the page is mapped read only, but loading an atomic needs it writable
+    // as far as the type system is concerned
+    atomic_uint *seq = (atomic_uint *) &page->seq;
+
+    for (int i = 0; i < READ_ATTEMPTS; i++)
+    {
+        unsigned before = atomic_load_explicit(seq, memory_order_acquire);
+        if (before % 2 == 0)
+        {
+            memcpy(snapshot, &page->snapshot, sizeof *snapshot);
+            // the copy must be complete before seq is checked again
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(seq, memory_order_relaxed) == before)
+            {
+                return true;
+            }
+        }
+        sched_yield();
+    }
+    return false;
+}
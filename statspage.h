@@ -0,0 +1,75 @@
+#ifndef STATSPAGE_H
+#define STATSPAGE_H
+
+#include "histogram.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+// A running game publishes its counters in the shared memory object
+// /snake-stats.<pid> for other processes to sample. The game is the only
+// writer and never waits: each update bumps seq to odd, writes, and bumps
+// it back to even. Readers copy the snapshot and retry if seq was odd or
+// changed while they copied.
+
+#define STATSPAGE_PREFIX "snake-stats."
+#define STATSPAGE_MAGIC 0x534b4e53
+#define STATSPAGE_VERSION 1
+#define STATSPAGE_STAGES 8
+#define STATSPAGE_NAME_LEN 16
+
+typedef struct StatsSnapshot
+{
+    int64_t tick;
+    int score;
+    int max_score;
+    double delay_ms;
+    int continues;
+    uint64_t allocs;
+    uint64_t frees;
+    uint64_t alloc_bytes;
+    int nstages;
+    char stage_names[STATSPAGE_STAGES][STATSPAGE_NAME_LEN];
+    Histogram stages[STATSPAGE_STAGES];
+}
+StatsSnapshot;
+
+typedef struct StatsPage
+{
+    uint32_t magic;
+    uint32_t version;
+    int32_t pid;
+    atomic_uint seq;
+    StatsSnapshot snapshot;
+}
+StatsPage;
+
+// creates and maps this process's page, NULL if shared memory is unavailable
+StatsPage *
+statspage_create(void);
+
+// unmaps and removes the page
+void
+statspage_destroy(StatsPage *page);
+
+// starts an update and returns the snapshot to change in place
+StatsSnapshot *
+statspage_begin(StatsPage *page);
+
+void
+statspage_end(StatsPage *page);
+
+// maps another process's page read only, NULL if it has none
+StatsPage const *
+statspage_open(pid_t pid);
+
+void
+statspage_close(StatsPage const *page);
+
+// a consistent copy of the snapshot, false if the writer seems to have
+// died halfway through an update
+bool
+statspage_read(StatsPage const *page, StatsSnapshot *snapshot);
+
+#endif // !STATSPAGE_H
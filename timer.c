@@ -1,24 +1,41 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include "timer.h"
 
+#define NS_PER_SEC 1000000000LL
+
 struct Timer
 {
-    time_t start_time;
-    time_t pause_time;
-    time_t unpause_time;
+    int64_t start_ns;
+    int64_t pause_ns;
+    // sum of every finished pause since the last (re)start
+    int64_t paused_total_ns;
     bool started;
     bool paused;
 };
 
+int64_t
+timer_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
 Timer *
 timer_new(void)
 {
     Timer *timer = malloc(sizeof *timer);
+    if (timer == NULL)
+    {
+        return NULL;
+    }
 
-    timer->start_time = 0;
-    timer->pause_time = 0;
-    timer->unpause_time = 0;
+    timer->start_ns = 0;
+    timer->pause_ns = 0;
+    timer->paused_total_ns = 0;
     timer->started = false;
     timer->paused = false;
 
@@ -36,7 +53,7 @@ timer_start(Timer *timer)
 {
     if (timer->started == false)
     {
-        timer->start_time = time(NULL);
+        timer->start_ns = timer_now_ns();
         timer->started = true;
     }
     else
@@ -50,10 +67,10 @@ timer_restart(Timer *timer)
 {
     if (timer->started == true)
     {
-        timer->start_time = time(NULL);
+        timer->start_ns = timer_now_ns();
         timer->paused = false;
-        timer->pause_time = 0;
-        timer->unpause_time = 0;
+        timer->pause_ns = 0;
+        timer->paused_total_ns = 0;
     }
     else
     {
@@ -75,7 +92,7 @@ timer_pause(Timer *timer)
     else
     {
         timer->paused = true;
-        timer->pause_time = time(NULL);
+        timer->pause_ns = timer_now_ns();
     }
 }
 
@@ -93,7 +110,7 @@ timer_unpause(Timer *timer)
     else
     {
         timer->paused = false;
-        timer->unpause_time = time(NULL);
+        timer->paused_total_ns += timer_now_ns() - timer->pause_ns;
     }
 }
 
@@ -103,8 +120,8 @@ timer_paused(Timer *timer)
     return timer->paused;
 }
 
-time_t
-timer_get_time(Timer *timer)
+int64_t
+timer_get_ns(Timer *timer)
 {
     if (timer->started == false)
     {
@@ -112,10 +129,16 @@ timer_get_time(Timer *timer)
     }
     else if (timer->paused == true)
     {
-        return timer->pause_time - timer->start_time;
+        return timer->pause_ns - timer->start_ns - timer->paused_total_ns;
     }
     else
     {
-        return time(NULL) - timer->start_time - (timer->unpause_time - timer->pause_time);
+        return timer_now_ns() - timer->start_ns - timer->paused_total_ns;
     }
 }
+
+time_t
+timer_get_time(Timer *timer)
+{
+    return timer_get_ns(timer) / NS_PER_SEC;
+}
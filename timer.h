@@ -3,9 +3,14 @@
 
 #include <time.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef struct Timer Timer;
 
+// CLOCK_MONOTONIC in nanoseconds, unaffected by wall clock changes
+int64_t
+timer_now_ns(void);
+
 Timer *
 timer_new(void);
 
@@ -27,6 +32,10 @@ timer_unpause(Timer *timer);
 bool
 timer_paused(Timer *timer);
 
+// running time excluding every pause so far
+int64_t
+timer_get_ns(Timer *timer);
+
 time_t
 timer_get_time(Timer *timer);
 
@@ -0,0 +1,37 @@
+#include "triplebuf.h"
+
+#define TRIPLEBUF_FRESH 4u
+#define TRIPLEBUF_SLOT 3u
+
+void
+triplebuf_init(TripleBuffer *tb)
+{
+    tb->write = 0;
+    atomic_init(&tb->middle, 1);
+    tb->read = 2;
+}
+
+bool
+triplebuf_publish(TripleBuffer *tb)
+{
+    // release: the slot's contents are visible before the reader can take it
+    unsigned old = atomic_exchange_explicit(
+        &tb->middle, tb->write | TRIPLEBUF_FRESH, memory_order_acq_rel);
+    tb->write = old & TRIPLEBUF_SLOT;
+    return (old & TRIPLEBUF_FRESH) == 0;
+}
+
+bool
+triplebuf_acquire(TripleBuffer *tb)
+{
+    if ((atomic_load_explicit(&tb->middle, memory_order_relaxed) &
+         TRIPLEBUF_FRESH) == 0)
+    {
+        return false;
+    }
+    // acquire: pairs with the release in triplebuf_publish
+    unsigned old = atomic_exchange_explicit(&tb->middle, tb->read,
+                                            memory_order_acq_rel);
+    tb->read = old & TRIPLEBUF_SLOT;
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef TRIPLEBUF_H
+#define TRIPLEBUF_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+// Hands values from one writer thread to one reader thread without locks or
+// waiting. The caller keeps three slots; the writer fills slot write and
+// publishes it, the reader takes the newest published slot into read.
+// Whatever the writer published that the reader never took is dropped.
+typedef struct TripleBuffer
+{
+    // the slot between the two sides, with TRIPLEBUF_FRESH set until the
+    // reader takes it
+    atomic_uint middle;
+    // owned by the writer
+    unsigned write;
+    // owned by the reader
+    unsigned read;
+}
+TripleBuffer;
+
+void
+triplebuf_init(TripleBuffer *tb);
+
+// swaps the filled write slot in, the writer continues in the slot it gets
+// back; false if that slot was never read, so a value was dropped
+bool
+triplebuf_publish(TripleBuffer *tb);
+
+// moves read to the newest published slot, false if nothing new arrived
+bool
+triplebuf_acquire(TripleBuffer *tb);
+
+#endif // !TRIPLEBUF_H
@@ -0,0 +1,333 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vecenv.h"
+
+typedef struct VecEnvWorker
+{
+    VecEnv *env;
+    pthread_t thread;
+    // the games this worker steps, the same ones every time
+    int begin;
+    int end;
+}
+VecEnvWorker;
+
+struct VecEnv
+{
+    int ngames;
+    int nlines;
+    int ncols;
+    int ncells;
+    long stall_limit;
+    Arena arena;
+    // one of each per game
+    Snake **games;
+    int *since_food;
+    uint8_t *obs;
+    float *rewards;
+    uint8_t *dones;
+    // workers[0] is the thread calling vecenv_step
+    VecEnvWorker *workers;
+    int nworkers;
+    // helper threads started, workers 1 to nthreads
+    int nthreads;
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t done;
+    // bumped for each step, which helpers play from actions
+    uint64_t job;
+    uint8_t const *actions;
+    int busy;
+    bool quit;
+};
+
+static uint8_t *
+vecenv_plane(VecEnv *env, int game, enum VECENV_PLANE plane)
+{
+    return env->obs + ((size_t) game * VECENV_PLANES + plane) * env->ncells;
+}
+
+static int
+vecenv_cell(VecEnv *env, Pose pos)
+{
+    return pos.y * env->ncols + pos.x;
+}
+
+// the game's obs from scratch, after a reset
+static void
+vecenv_draw(VecEnv *env, int game)
+{
+    Snake *snake = env->games[game];
+    uint8_t *body = vecenv_plane(env, game, VECENV_PLANE_body);
+    memset(body, 0, VECENV_PLANES * env->ncells);
+    for (int i = 0; i < snake->deq->length; i++)
+    {
+        body[vecenv_cell(env, deque_get(snake->deq, i))] = 1;
+    }
+    vecenv_plane(env, game, VECENV_PLANE_head)
+        [vecenv_cell(env, snake_get_head(snake))] = 1;
+    vecenv_plane(env, game, VECENV_PLANE_food)
+        [vecenv_cell(env, snake->food_pos)] = 1;
+    snake_clear_dirty(snake);
+}
+
+static void
+vecenv_restart(VecEnv *env, int game)
+{
+    Snake *snake = env->games[game];
+    snake_reset(snake, rng_next(&snake->rng));
+    env->since_food[game] = 0;
+    if (env->obs != NULL)
+    {
+        vecenv_draw(env, game);
+    }
+}
+
+// only the cells the move changed are written
+static void
+vecenv_step_game(VecEnv *env, int game, enum DIRECTION action)
+{
+    Snake *snake = env->games[game];
+    Pose head = snake_get_head(snake);
+    Pose food = snake->food_pos;
+    int length = snake->deq->length;
+    float reward = 0;
+    enum VECENV_DONE done = VECENV_DONE_none;
+
+    if (action >= DIRECTION_left && action <= DIRECTION_down)
+    {
+        snake_set_direction(snake, action);
+    }
+    snake_update(snake);
+    if (snake->state == STATE_lose)
+    {
+        reward = -1;
+        done = VECENV_DONE_lose;
+    }
+    else if (snake->state == STATE_win)
+    {
+        reward = 1;
+        done = VECENV_DONE_win;
+    }
+    else if (snake->deq->length != length)
+    {
+        reward = 1;
+        env->since_food[game] = 0;
+    }
+    else if (++env->since_food[game] > env->stall_limit)
+    {
+        done = VECENV_DONE_stalled;
+    }
+    env->rewards[game] = reward;
+    env->dones[game] = done;
+    if (done != VECENV_DONE_none)
+    {
+        vecenv_restart(env, game);
+        return;
+    }
+
+    uint8_t *body = vecenv_plane(env, game, VECENV_PLANE_body);
+    for (int i = 0; i < snake->ndirty; i++)
+    {
+        int cell = vecenv_cell(env, snake->dirty[i]);
+        body[cell] = snake->occupied[cell];
+    }
+    uint8_t *heads = vecenv_plane(env, game, VECENV_PLANE_head);
+    heads[vecenv_cell(env, head)] = 0;
+    heads[vecenv_cell(env, snake_get_head(snake))] = 1;
+    uint8_t *foods = vecenv_plane(env, game, VECENV_PLANE_food);
+    foods[vecenv_cell(env, food)] = 0;
+    foods[vecenv_cell(env, snake->food_pos)] = 1;
+    snake_clear_dirty(snake);
+}
+
+static void
+vecenv_step_range(VecEnvWorker *worker, uint8_t const *actions)
+{
+    for (int i = worker->begin; i < worker->end; i++)
+    {
+        vecenv_step_game(worker->env, i, actions[i]);
+    }
+}
+
+static void *
+vecenv_worker_run(void *arg)
+{
+    VecEnvWorker *worker = arg;
+    VecEnv *env = worker->env;
+    uint64_t job = 0;
+    pthread_mutex_lock(&env->lock);
+    while (true)
+    {
+        while (env->job == job && env->quit == false)
+        {
+            pthread_cond_wait(&env->work, &env->lock);
+        }
+        if (env->quit)
+        {
+            break;
+        }
+        job = env->job;
+        uint8_t const *actions = env->actions;
+        pthread_mutex_unlock(&env->lock);
+
+        vecenv_step_range(worker, actions);
+
+        pthread_mutex_lock(&env->lock);
+        if (--env->busy == 0)
+        {
+            pthread_cond_signal(&env->done);
+        }
+    }
+    pthread_mutex_unlock(&env->lock);
+    return NULL;
+}
+
+VecEnv *
+vecenv_new(int ngames, int nlines, int ncols, uint64_t seed, int nthreads)
+{
+    if (ngames <= 0 || nlines <= 0 || ncols <= 0)
+    {
+        return NULL;
+    }
+    VecEnv *env = calloc(1, sizeof *env);
+    if (env == NULL)
+    {
+        return NULL;
+    }
+    env->ngames = ngames;
+    env->nlines = nlines;
+    env->ncols = ncols;
+    env->ncells = nlines * ncols;
+    env->stall_limit = (long) env->ncells * SNAKE_STALL_TICKS_PER_CELL;
+    env->nworkers = nthreads < 1 ? 1 : nthreads > ngames ? ngames : nthreads;
+    pthread_mutex_init(&env->lock, NULL);
+    pthread_cond_init(&env->work, NULL);
+    pthread_cond_init(&env->done, NULL);
+
+    size_t size = arena_footprint(ngames * sizeof *env->games) +
+                  arena_footprint(ngames * sizeof *env->since_food) +
+                  arena_footprint(env->nworkers * sizeof *env->workers) +
+                  ngames * snake_arena_size(nlines, ncols);
+    if (arena_init(&env->arena, size) == false)
+    {
+        vecenv_destroy(env);
+        return NULL;
+    }
+    env->games = arena_alloc(&env->arena, ngames * sizeof *env->games);
+    env->since_food =
+        arena_alloc(&env->arena, ngames * sizeof *env->since_food);
+    env->workers =
+        arena_alloc(&env->arena, env->nworkers * sizeof *env->workers);
+    Rng rng;
+    rng_seed(&rng, seed);
+    for (int i = 0; i < ngames; i++)
+    {
+        env->games[i] =
+            snake_new_in(&env->arena, nlines, ncols, rng_next(&rng));
+    }
+
+    for (int i = 0; i < env->nworkers; i++)
+    {
+        env->workers[i] = (VecEnvWorker) {
+            .env = env,
+            .begin = (int) ((long) ngames * i / env->nworkers),
+            .end = (int) ((long) ngames * (i + 1) / env->nworkers),
+        };
+    }
+    for (int i = 1; i < env->nworkers; i++)
+    {
+        if (pthread_create(&env->workers[i].thread, NULL, vecenv_worker_run,
+                           &env->workers[i]) != 0)
+        {
+            vecenv_destroy(env);
+            return NULL;
+        }
+        env->nthreads = i;
+    }
+    return env;
+}
+
+void
+vecenv_destroy(VecEnv *env)
+{
+    pthread_mutex_lock(&env->lock);
+    env->quit = true;
+    pthread_cond_broadcast(&env->work);
+    pthread_mutex_unlock(&env->lock);
+    for (int i = 1; i <= env->nthreads; i++)
+    {
+        pthread_join(env->workers[i].thread, NULL);
+    }
+    pthread_mutex_destroy(&env->lock);
+    pthread_cond_destroy(&env->work);
+    pthread_cond_destroy(&env->done);
+    arena_release(&env->arena);
+    free(env);
+}
+
+size_t
+vecenv_obs_size(VecEnv const *env)
+{
+    return (size_t) VECENV_PLANES * env->ncells;
+}
+
+void
+vecenv_bind(VecEnv *env, uint8_t *obs, float *rewards, uint8_t *dones)
+{
+    env->obs = obs;
+    env->rewards = rewards;
+    env->dones = dones;
+    for (int i = 0; i < env->ngames; i++)
+    {
+        vecenv_draw(env, i);
+        rewards[i] = 0;
+        dones[i] = VECENV_DONE_none;
+    }
+}
+
+void
+vecenv_reset(VecEnv *env)
+{
+    for (int i = 0; i < env->ngames; i++)
+    {
+        vecenv_restart(env, i);
+        if (env->rewards != NULL)
+        {
+            env->rewards[i] = 0;
+            env->dones[i] = VECENV_DONE_none;
+        }
+    }
+}
+
+void
+vecenv_step(VecEnv *env, uint8_t const *actions)
+{
+    if (env->nworkers == 1)
+    {
+        vecenv_step_range(&env->workers[0], actions);
+        return;
+    }
+    pthread_mutex_lock(&env->lock);
+    env->actions = actions;
+    env->busy = env->nworkers - 1;
+    env->job++;
+    pthread_cond_broadcast(&env->work);
+    pthread_mutex_unlock(&env->lock);
+
+    vecenv_step_range(&env->workers[0], actions);
+
+    pthread_mutex_lock(&env->lock);
+    while (env->busy > 0)
+    {
+        pthread_cond_wait(&env->done, &env->lock);
+    }
+    pthread_mutex_unlock(&env->lock);
+}
+
+Snake const *
+vecenv_game(VecEnv const *env, int game)
+{
+    return env->games[game];
+}
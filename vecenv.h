@@ -0,0 +1,71 @@
+#ifndef VECENV_H
+#define VECENV_H
+
+#include "snakecore.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Many games on one board size stepped together, for training policies:
+// one call moves every game by its action, writes what each one looks like
+// now and what the move earned straight into the caller's buffers, and
+// starts a finished game over on the spot. Each game is a whole Snake,
+// stepped by snake_update, so the games are an array of structs, not a
+// struct of arrays: a step touches one Snake's memory at a time rather
+// than a field of every game. The Snakes lie back to back in one arena,
+// so stepping never allocates. Struct of arrays is kept to the caller's
+// buffers, contiguous and indexed by game:
+//   actions  u8 [ngames] enum DIRECTION, DIRECTION_null keeps the heading
+//   obs      u8 [ngames][VECENV_PLANES][nlines][ncols], each 0 or 1
+//   rewards  float [ngames], 1 for eating, -1 for dying, 0 otherwise
+//   dones    u8 [ngames] enum VECENV_DONE; a game that is done has already
+//            been reset and its obs is the new game's first position
+
+enum VECENV_PLANE
+{
+    // the whole body, head included
+    VECENV_PLANE_body,
+    VECENV_PLANE_head,
+    VECENV_PLANE_food,
+    VECENV_PLANES,
+};
+
+enum VECENV_DONE
+{
+    VECENV_DONE_none,
+    VECENV_DONE_lose,
+    VECENV_DONE_win,
+    // went SNAKE_STALL_TICKS_PER_CELL steps per cell without eating
+    VECENV_DONE_stalled,
+};
+
+typedef struct VecEnv VecEnv;
+
+// nthreads splits the games between that many threads, the caller's
+// included; NULL if the games could not be allocated
+VecEnv *
+vecenv_new(int ngames, int nlines, int ncols, uint64_t seed, int nthreads);
+
+void
+vecenv_destroy(VecEnv *env);
+
+// bytes of obs one game takes
+size_t
+vecenv_obs_size(VecEnv const *env);
+
+// where steps write from now on; writes every game's obs and clears
+// rewards and dones
+void
+vecenv_bind(VecEnv *env, uint8_t *obs, float *rewards, uint8_t *dones);
+
+// starts every game over, each from its own next seed
+void
+vecenv_reset(VecEnv *env);
+
+// one move in every game; needs buffers bound
+void
+vecenv_step(VecEnv *env, uint8_t const *actions);
+
+Snake const *
+vecenv_game(VecEnv const *env, int game);
+
+#endif // !VECENV_H